@@ -0,0 +1,67 @@
+#.rst:
+# FindLZ4
+# -------
+#
+# Try to find the LZ4 compression library.
+#
+# This will define the following variables:
+#
+# ``LZ4_FOUND``
+#     True if liblz4 is available.
+#
+# ``LZ4_VERSION``
+#     The version of liblz4
+#
+# ``LZ4_INCLUDE_DIRS``
+#     This should be passed to target_include_directories() if
+#     the target is not used for linking
+#
+# ``LZ4_LIBRARIES``
+#     This can be passed to target_link_libraries() instead of
+#     the ``LZ4::LZ4`` target
+#
+# If ``LZ4_FOUND`` is TRUE, the following imported target
+# will be available:
+#
+# ``LZ4::LZ4``
+#     The LZ4 library
+#
+#=============================================================================
+# Copyright 2022 by the Quassel Project
+#
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+#=============================================================================
+
+find_path(LZ4_INCLUDE_DIRS NAMES lz4frame.h)
+find_library(LZ4_LIBRARIES NAMES lz4 liblz4)
+
+if(EXISTS ${LZ4_INCLUDE_DIRS}/lz4.h)
+    file(READ ${LZ4_INCLUDE_DIRS}/lz4.h LZ4_H_CONTENT)
+    string(REGEX MATCH "#define LZ4_VERSION_MAJOR[ ]+[0-9]+" _LZ4_VERSION_MAJOR_MATCH ${LZ4_H_CONTENT})
+    string(REGEX MATCH "#define LZ4_VERSION_MINOR[ ]+[0-9]+" _LZ4_VERSION_MINOR_MATCH ${LZ4_H_CONTENT})
+    string(REGEX MATCH "#define LZ4_VERSION_RELEASE[ ]+[0-9]+" _LZ4_VERSION_RELEASE_MATCH ${LZ4_H_CONTENT})
+
+    string(REGEX REPLACE ".*_MAJOR[ ]+(.*)" "\\1" LZ4_VERSION_MAJOR ${_LZ4_VERSION_MAJOR_MATCH})
+    string(REGEX REPLACE ".*_MINOR[ ]+(.*)" "\\1" LZ4_VERSION_MINOR ${_LZ4_VERSION_MINOR_MATCH})
+    string(REGEX REPLACE ".*_RELEASE[ ]+(.*)" "\\1" LZ4_VERSION_RELEASE ${_LZ4_VERSION_RELEASE_MATCH})
+
+    set(LZ4_VERSION "${LZ4_VERSION_MAJOR}.${LZ4_VERSION_MINOR}.${LZ4_VERSION_RELEASE}")
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4
+    FOUND_VAR LZ4_FOUND
+    REQUIRED_VARS LZ4_LIBRARIES LZ4_INCLUDE_DIRS
+    VERSION_VAR LZ4_VERSION
+)
+
+if (LZ4_FOUND AND NOT TARGET LZ4::LZ4)
+    add_library(LZ4::LZ4 UNKNOWN IMPORTED)
+    set_target_properties(LZ4::LZ4 PROPERTIES
+        IMPORTED_LOCATION "${LZ4_LIBRARIES}"
+        INTERFACE_INCLUDE_DIRECTORIES "${LZ4_INCLUDE_DIRS}"
+    )
+endif()
+
+mark_as_advanced(LZ4_INCLUDE_DIRS LZ4_LIBRARIES LZ4_VERSION)
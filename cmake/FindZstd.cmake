@@ -0,0 +1,67 @@
+#.rst:
+# FindZstd
+# --------
+#
+# Try to find the Zstandard compression library.
+#
+# This will define the following variables:
+#
+# ``Zstd_FOUND``
+#     True if libzstd is available.
+#
+# ``Zstd_VERSION``
+#     The version of libzstd
+#
+# ``Zstd_INCLUDE_DIRS``
+#     This should be passed to target_include_directories() if
+#     the target is not used for linking
+#
+# ``Zstd_LIBRARIES``
+#     This can be passed to target_link_libraries() instead of
+#     the ``Zstd::Zstd`` target
+#
+# If ``Zstd_FOUND`` is TRUE, the following imported target
+# will be available:
+#
+# ``Zstd::Zstd``
+#     The Zstandard library
+#
+#=============================================================================
+# Copyright 2022 by the Quassel Project
+#
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+#=============================================================================
+
+find_path(Zstd_INCLUDE_DIRS NAMES zstd.h)
+find_library(Zstd_LIBRARIES NAMES zstd zstd_static)
+
+if(EXISTS ${Zstd_INCLUDE_DIRS}/zstd.h)
+    file(READ ${Zstd_INCLUDE_DIRS}/zstd.h ZSTD_H_CONTENT)
+    string(REGEX MATCH "#define ZSTD_VERSION_MAJOR[ ]+[0-9]+" _ZSTD_VERSION_MAJOR_MATCH ${ZSTD_H_CONTENT})
+    string(REGEX MATCH "#define ZSTD_VERSION_MINOR[ ]+[0-9]+" _ZSTD_VERSION_MINOR_MATCH ${ZSTD_H_CONTENT})
+    string(REGEX MATCH "#define ZSTD_VERSION_RELEASE[ ]+[0-9]+" _ZSTD_VERSION_RELEASE_MATCH ${ZSTD_H_CONTENT})
+
+    string(REGEX REPLACE ".*_MAJOR[ ]+(.*)" "\\1" ZSTD_VERSION_MAJOR ${_ZSTD_VERSION_MAJOR_MATCH})
+    string(REGEX REPLACE ".*_MINOR[ ]+(.*)" "\\1" ZSTD_VERSION_MINOR ${_ZSTD_VERSION_MINOR_MATCH})
+    string(REGEX REPLACE ".*_RELEASE[ ]+(.*)" "\\1" ZSTD_VERSION_RELEASE ${_ZSTD_VERSION_RELEASE_MATCH})
+
+    set(Zstd_VERSION "${ZSTD_VERSION_MAJOR}.${ZSTD_VERSION_MINOR}.${ZSTD_VERSION_RELEASE}")
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Zstd
+    FOUND_VAR Zstd_FOUND
+    REQUIRED_VARS Zstd_LIBRARIES Zstd_INCLUDE_DIRS
+    VERSION_VAR Zstd_VERSION
+)
+
+if (Zstd_FOUND AND NOT TARGET Zstd::Zstd)
+    add_library(Zstd::Zstd UNKNOWN IMPORTED)
+    set_target_properties(Zstd::Zstd PROPERTIES
+        IMPORTED_LOCATION "${Zstd_LIBRARIES}"
+        INTERFACE_INCLUDE_DIRECTORIES "${Zstd_INCLUDE_DIRS}"
+    )
+endif()
+
+mark_as_advanced(Zstd_INCLUDE_DIRS Zstd_LIBRARIES Zstd_VERSION)
@@ -363,6 +363,49 @@ function(quassel_add_test _target)
     )
 endfunction()
 
+###################################################################################################
+# Adds a benchmark
+#
+# quassel_add_benchmark(BenchmarkName
+#                       [LIBRARIES lib1 lib2...]
+# )
+#
+# Works like quassel_add_test(), but the benchmark is not registered with CTest, so it is only run
+# when explicitly invoked. Benchmarks are only built if BUILD_BENCHMARKS is enabled.
+#
+# The compiled benchmark binary is located in the benchmark/ directory in the build directory.
+#
+function(quassel_add_benchmark _target)
+    set(options )
+    set(oneValueArgs )
+    set(multiValueArgs LIBRARIES)
+    cmake_parse_arguments(ARG "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    string(TOLOWER ${_target} lower_target)
+    set(srcfile ${lower_target}.cpp)
+
+    list(APPEND ARG_LIBRARIES
+        Qt5::Test
+        Quassel::Common
+        Quassel::Test::Global
+        Quassel::Test::Main
+    )
+
+    if (WIN32)
+        set(output_dir "${CMAKE_RUNTIME_OUTPUT_DIRECTORY}")
+    else()
+        set(output_dir "${CMAKE_BINARY_DIR}/benchmark")
+    endif()
+
+    add_executable(${_target} ${srcfile})
+    set_target_properties(${_target} PROPERTIES
+        OUTPUT_NAME ${_target}
+        RUNTIME_OUTPUT_DIRECTORY "${output_dir}"
+    )
+    target_include_directories(${_target} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR})
+    target_link_libraries(${_target} PUBLIC ${ARG_LIBRARIES})
+endfunction()
+
 ###################################################################################################
 # target_link_if_exists(Target
 #                       [PUBLIC dep1 dep2...]
@@ -39,6 +39,14 @@ public slots:
     virtual void process(QList<Message>& msgs) = 0;
     virtual void networkRemoved(NetworkId id) = 0;
 
+signals:
+    /**
+     * Reports on a run of batch processing, emitted once all queued messages have been processed
+     *
+     * @param msg Human-readable summary, suitable for the status bar
+     */
+    void messagesProcessed(const QString& msg);
+
 protected:
     // updateBufferActivity also sets the Message::Redirected flag which is later used
     // to determine where a message should be displayed. therefore it's crucial that it
@@ -55,6 +55,30 @@ BufferIdList BacklogRequester::allBufferIds() const
     return bufferIds.values();
 }
 
+void BacklogRequester::requestBacklogs(const BufferIdList& bufferIds, int limit, int additional, bool sinceLastSeen)
+{
+    auto firstMsgId = [sinceLastSeen](BufferId bufferId) {
+        return sinceLastSeen ? Client::networkModel()->lastSeenMsgId(bufferId) : MsgId(-1);
+    };
+
+    if (!Client::isCoreFeatureEnabled(Quassel::Feature::BacklogBatchRequest)) {
+        foreach (BufferId bufferId, bufferIds) {
+            backlogManager->requestBacklog(bufferId, firstMsgId(bufferId), -1, limit, additional);
+        }
+        return;
+    }
+
+    QVariantList requests;
+    foreach (BufferId bufferId, bufferIds) {
+        requests << QVariant(QVariantList{QVariant::fromValue(bufferId),
+                                          QVariant::fromValue(firstMsgId(bufferId)),
+                                          QVariant::fromValue(MsgId(-1)),
+                                          limit,
+                                          additional});
+    }
+    backlogManager->requestBacklogBatch(requests);
+}
+
 void BacklogRequester::flushBuffer()
 {
     if (!_buffersWaiting.empty()) {
@@ -81,9 +105,7 @@ void FixedBacklogRequester::requestBacklog(const BufferIdList& bufferIds)
     backlogManager->emitMessagesRequested(QObject::tr("Requesting a total of up to %1 backlog messages for %2 buffers")
                                               .arg(_backlogCount * bufferIds.count())
                                               .arg(bufferIds.count()));
-    foreach (BufferId bufferId, bufferIds) {
-        backlogManager->requestBacklog(bufferId, -1, -1, _backlogCount);
-    }
+    requestBacklogs(bufferIds, _backlogCount);
 }
 
 // ========================================
@@ -127,9 +149,7 @@ void PerBufferUnreadBacklogRequester::requestBacklog(const BufferIdList& bufferI
     backlogManager->emitMessagesRequested(QObject::tr("Requesting a total of up to %1 unread backlog messages for %2 buffers")
                                               .arg((_limit + _additional) * bufferIds.count())
                                               .arg(bufferIds.count()));
-    foreach (BufferId bufferId, bufferIds) {
-        backlogManager->requestBacklog(bufferId, Client::networkModel()->lastSeenMsgId(bufferId), -1, _limit, _additional);
-    }
+    requestBacklogs(bufferIds, _limit, _additional, true);
 }
 
 // ========================================
@@ -154,7 +174,5 @@ void AsNeededBacklogRequester::requestBacklog(const BufferIdList& bufferIds)
     backlogManager->emitMessagesRequested(QObject::tr("Requesting a total of up to %1 backlog messages for %2 buffers")
                                               .arg(_legacyBacklogCount * bufferIds.count())
                                               .arg(bufferIds.count()));
-    foreach (BufferId bufferId, bufferIds) {
-        backlogManager->requestBacklog(bufferId, -1, -1, _legacyBacklogCount);
-    }
+    requestBacklogs(bufferIds, _legacyBacklogCount);
 }
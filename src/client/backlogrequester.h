@@ -64,6 +64,16 @@ protected:
     BufferIdList allBufferIds() const;
     void setWaitingBuffers(const BufferIdList& buffers);
 
+    /**
+     * Requests backlog for the given buffers, as a single batched request if the core supports it.
+     *
+     * @param bufferIds    Buffers to request backlog for
+     * @param limit        Maximum number of messages per buffer
+     * @param additional   Number of additional messages per buffer, see BacklogManager::requestBacklog()
+     * @param sinceLastSeen Only request messages newer than each buffer's last seen message
+     */
+    void requestBacklogs(const BufferIdList& bufferIds, int limit, int additional = 0, bool sinceLastSeen = false);
+
     ClientBacklogManager* backlogManager;
 
 private:
@@ -195,6 +195,10 @@ void ClientAuthHandler::onImplicitTlsSocketEncrypted()
 
     quint32 magic = Protocol::magic;
     magic |= Protocol::Compression;
+    if (Compressor::isSupported(Compressor::Zstd))
+        magic |= Protocol::ZstdCompression;
+    if (Compressor::isSupported(Compressor::Lz4))
+        magic |= Protocol::Lz4Compression;
     // Note that the core will think that we don't support encryption
 
     stream << magic;
@@ -230,6 +234,10 @@ void ClientAuthHandler::onSocketConnected()
         quint32 magic = Protocol::magic;
         magic |= Protocol::Encryption;
         magic |= Protocol::Compression;
+        if (Compressor::isSupported(Compressor::Zstd))
+            magic |= Protocol::ZstdCompression;
+        if (Compressor::isSupported(Compressor::Lz4))
+            magic |= Protocol::Lz4Compression;
 
         stream << magic;
 
@@ -255,6 +263,7 @@ void ClientAuthHandler::onSocketConnected()
                                          this,
                                          socket(),
                                          Compressor::NoCompression,
+                                         Compressor::Deflate,
                                          this);
     // Only needed for the legacy peer, as all others check the protocol version before instantiation
     connect(peer, &RemotePeer::protocolVersionMismatch, this, &ClientAuthHandler::onProtocolVersionMismatch);
@@ -282,12 +291,21 @@ void ClientAuthHandler::onReadyRead()
     _connectionFeatures = static_cast<quint8>(reply >> 24);
 
     Compressor::CompressionLevel level;
-    if (_connectionFeatures & Protocol::Compression)
+    Compressor::Algorithm algorithm = Compressor::Deflate;
+    if (_connectionFeatures & Protocol::ZstdCompression) {
+        level = Compressor::DefaultCompression;
+        algorithm = Compressor::Zstd;
+    }
+    else if (_connectionFeatures & Protocol::Lz4Compression) {
+        level = Compressor::DefaultCompression;
+        algorithm = Compressor::Lz4;
+    }
+    else if (_connectionFeatures & Protocol::Compression)
         level = Compressor::BestCompression;
     else
         level = Compressor::NoCompression;
 
-    RemotePeer* peer = PeerFactory::createPeer(PeerFactory::ProtoDescriptor(type, protoFeatures), this, socket(), level, this);
+    RemotePeer* peer = PeerFactory::createPeer(PeerFactory::ProtoDescriptor(type, protoFeatures), this, socket(), level, algorithm, this);
     if (!peer) {
         qWarning() << "No valid protocol supported for this core!";
         emit errorPopup(tr("<b>Incompatible Quassel Core!</b><br>"
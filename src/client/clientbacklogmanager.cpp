@@ -21,7 +21,6 @@
 #include "clientbacklogmanager.h"
 
 #include <algorithm>
-#include <ctime>
 
 #include <QDebug>
 
@@ -83,10 +82,42 @@ void ClientBacklogManager::receiveBacklogAll(MsgId first, MsgId last, int limit,
         msg.setFlags(msg.flags() | Message::Backlog);
         msglist << msg;
     }
+    _backlogAllReceived += msglist.count();
 
     dispatchMessages(msglist);
 }
 
+void ClientBacklogManager::receiveBacklogAllComplete(MsgId first, MsgId last, int limit, int additional)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+    Q_UNUSED(limit)
+    Q_UNUSED(additional)
+
+    emit messagesProcessed(tr("Received %n backlog message(s).", "", _backlogAllReceived));
+    _backlogAllReceived = 0;
+}
+
+void ClientBacklogManager::requestBacklogBatch(QVariantList requests)
+{
+    for (const QVariant& request : requests) {
+        _buffersRequested << request.toList().value(0).value<BufferId>();
+    }
+    BacklogManager::requestBacklogBatch(requests);
+}
+
+void ClientBacklogManager::receiveBacklogBatch(QVariantList backlogs)
+{
+    for (const QVariant& backlog : backlogs) {
+        QVariantList parts = backlog.toList();
+        if (parts.count() < 2) {
+            qWarning() << "ClientBacklogManager::receiveBacklogBatch(): ignoring malformed backlog part";
+            continue;
+        }
+        receiveBacklog(parts[0].value<BufferId>(), -1, -1, -1, 0, parts[1].toList());
+    }
+}
+
 void ClientBacklogManager::requestInitialBacklog()
 {
     if (_initBacklogRequested) {
@@ -168,13 +199,10 @@ void ClientBacklogManager::dispatchMessages(const MessageList& messages, bool so
 
     MessageList msgs = messages;
 
-    clock_t start_t = clock();
     if (sort)
         std::sort(msgs.begin(), msgs.end());
+    // Only queues the messages, the processor reports once it is done with them
     Client::messageProcessor()->process(msgs);
-    clock_t end_t = clock();
-
-    emit messagesProcessed(tr("Processed %1 messages in %2 seconds.").arg(messages.count()).arg((float)(end_t - start_t) / CLOCKS_PER_SEC));
 }
 
 void ClientBacklogManager::reset()
@@ -183,4 +211,5 @@ void ClientBacklogManager::reset()
     _requester = nullptr;
     _initBacklogRequested = false;
     _buffersRequested.clear();
+    _backlogAllReceived = 0;
 }
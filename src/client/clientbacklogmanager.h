@@ -43,6 +43,9 @@ public slots:
     QVariantList requestBacklog(BufferId bufferId, MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0) override;
     void receiveBacklog(BufferId bufferId, MsgId first, MsgId last, int limit, int additional, QVariantList msgs) override;
     void receiveBacklogAll(MsgId first, MsgId last, int limit, int additional, QVariantList msgs) override;
+    void receiveBacklogAllComplete(MsgId first, MsgId last, int limit, int additional) override;
+    void requestBacklogBatch(QVariantList requests) override;
+    void receiveBacklogBatch(QVariantList backlogs) override;
 
     void requestInitialBacklog();
 
@@ -65,6 +68,7 @@ private:
     BacklogRequester* _requester{nullptr};
     bool _initBacklogRequested{false};
     QSet<BufferId> _buffersRequested;
+    int _backlogAllReceived{0};  ///< Messages received so far for a streamed requestBacklogAll()
 };
 
 // inlines
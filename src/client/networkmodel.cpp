@@ -905,22 +905,14 @@ void ChannelBufferItem::userModeChanged(IrcUser* ircUser)
     }
 
     // find the item that needs reparenting
-    IrcUserItem* ircUserItem = nullptr;
     for (int i = 0; i < childCount(); i++) {
         auto* oldCategoryItem = qobject_cast<UserCategoryItem*>(child(i));
         Q_ASSERT(oldCategoryItem);
-        IrcUserItem* userItem = oldCategoryItem->findIrcUser(ircUser);
-        if (userItem) {
-            ircUserItem = userItem;
-            break;
-        }
+        if (oldCategoryItem->moveUser(ircUser, categoryItem))
+            return;
     }
 
-    if (!ircUserItem) {
-        qWarning() << "ChannelBufferItem::userModeChanged(IrcUser *): unable to determine old category of" << ircUser;
-        return;
-    }
-    ircUserItem->reParent(categoryItem);
+    qWarning() << "ChannelBufferItem::userModeChanged(IrcUser *): unable to determine old category of" << ircUser;
 }
 
 /*****************************************
@@ -967,23 +959,22 @@ QString UserCategoryItem::categoryName() const
 
 IrcUserItem* UserCategoryItem::findIrcUser(IrcUser* ircUser)
 {
-    IrcUserItem* userItem = nullptr;
-
-    for (int i = 0; i < childCount(); i++) {
-        userItem = qobject_cast<IrcUserItem*>(child(i));
-        if (!userItem)
-            continue;
-        if (userItem->ircUser() == ircUser)
-            return userItem;
-    }
-    return nullptr;
+    IrcUserItem* userItem = _userItems.value(ircUser);
+    // An item whose user got deleted might still be registered, and its address reused by another user
+    if (userItem && userItem->ircUser() != ircUser)
+        return nullptr;
+    return userItem;
 }
 
 void UserCategoryItem::addUsers(const QList<IrcUser*>& ircUsers)
 {
     QList<AbstractTreeItem*> userItems;
-    foreach (IrcUser* ircUser, ircUsers)
-        userItems << new IrcUserItem(ircUser, this);
+    userItems.reserve(ircUsers.count());
+    foreach (IrcUser* ircUser, ircUsers) {
+        auto* userItem = new IrcUserItem(ircUser, this);
+        _userItems.insert(ircUser, userItem);
+        userItems << userItem;
+    }
     newChilds(userItems);
     emit dataChanged(0);
 }
@@ -993,12 +984,26 @@ bool UserCategoryItem::removeUser(IrcUser* ircUser)
     IrcUserItem* userItem = findIrcUser(ircUser);
     auto success = (bool)userItem;
     if (success) {
+        _userItems.remove(ircUser);
         removeChild(userItem);
         emit dataChanged(0);
     }
     return success;
 }
 
+bool UserCategoryItem::moveUser(IrcUser* ircUser, UserCategoryItem* newCategory)
+{
+    IrcUserItem* userItem = findIrcUser(ircUser);
+    if (!userItem)
+        return false;
+
+    _userItems.remove(ircUser);
+    newCategory->_userItems.insert(ircUser, userItem);
+    // reParent() may schedule this category for deletion, so it must come last
+    userItem->reParent(newCategory);
+    return true;
+}
+
 int UserCategoryItem::categoryFromModes(const QString& modes)
 {
     for (int i = 0; i < categories.count(); i++) {
@@ -1041,6 +1046,14 @@ IrcUserItem::IrcUserItem(IrcUser* ircUser, AbstractTreeItem* parent)
     connect(ircUser, &IrcUser::awaySet, this, [this]() { emit dataChanged(); });
 }
 
+void IrcUserItem::ircUserQuited()
+{
+    auto* category = qobject_cast<UserCategoryItem*>(parent());
+    if (category && category->removeUser(_ircUser))
+        return;
+    parent()->removeChild(this);
+}
+
 QStringList IrcUserItem::propertyOrder() const
 {
     static QStringList order{"nickName"};
@@ -264,11 +264,13 @@ public:
     IrcUserItem* findIrcUser(IrcUser* ircUser);
     void addUsers(const QList<IrcUser*>& ircUser);
     bool removeUser(IrcUser* ircUser);
+    bool moveUser(IrcUser* ircUser, UserCategoryItem* newCategory);
 
     static int categoryFromModes(const QString& modes);
 
 private:
     int _category;
+    QHash<IrcUser*, IrcUserItem*> _userItems;  ///< Child items by user, so large channels don't need to be searched
 
     static const QList<QChar> categories;
 };
@@ -301,7 +303,7 @@ public:
     QString channelModes() const;
 
 private slots:
-    inline void ircUserQuited() { parent()->removeChild(this); }
+    void ircUserQuited();
 
 private:
     QPointer<IrcUser> _ircUser;
@@ -20,6 +20,7 @@
 
 #include "treemodel.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QCoreApplication>
@@ -51,6 +52,7 @@ bool AbstractTreeItem::newChild(AbstractTreeItem* item)
 {
     int newRow = childCount();
     emit beginAppendChilds(newRow, newRow);
+    item->_rowKey = _childItems.isEmpty() ? 0 : _childItems.last()->_rowKey + 1;
     _childItems.append(item);
     emit endAppendChilds();
     return true;
@@ -65,6 +67,9 @@ bool AbstractTreeItem::newChilds(const QList<AbstractTreeItem*>& items)
     int lastRow = nextRow + items.count() - 1;
 
     emit beginAppendChilds(nextRow, lastRow);
+    int rowKey = _childItems.isEmpty() ? 0 : _childItems.last()->_rowKey + 1;
+    for (AbstractTreeItem* item : items)
+        item->_rowKey = rowKey++;
     _childItems << items;
     emit endAppendChilds();
 
@@ -132,7 +137,7 @@ void AbstractTreeItem::customEvent(QEvent* event)
     event->accept();
 
     auto* removeEvent = static_cast<RemoveChildLaterEvent*>(event);
-    int childRow = _childItems.indexOf(removeEvent->child());
+    int childRow = rowOf(removeEvent->child());
     if (childRow == -1)
         return;
 
@@ -197,12 +202,23 @@ int AbstractTreeItem::row() const
         return -1;
     }
 
-    int row_ = parent()->_childItems.indexOf(const_cast<AbstractTreeItem*>(this));
+    int row_ = parent()->rowOf(this);
     if (row_ == -1)
         qWarning() << "AbstractTreeItem::row():" << this << "is not in the child list of" << QObject::parent();
     return row_;
 }
 
+int AbstractTreeItem::rowOf(const AbstractTreeItem* child) const
+{
+    auto it = std::lower_bound(_childItems.constBegin(), _childItems.constEnd(), child->_rowKey, [](const AbstractTreeItem* item, int key) {
+        return item->_rowKey < key;
+    });
+    // The key might also stem from a previous parent, so verify we actually found the child
+    if (it == _childItems.constEnd() || *it != child)
+        return -1;
+    return it - _childItems.constBegin();
+}
+
 void AbstractTreeItem::dumpChildList()
 {
     qDebug() << "==== Childlist for Item:" << this << "====";
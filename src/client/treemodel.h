@@ -90,6 +90,11 @@ private:
     Qt::ItemFlags _flags{};
     TreeItemFlags _treeItemFlags{};
 
+    // Children are only ever appended, so each one gets a key that increases along the parent's child list.
+    // row() can then binary search for it, no matter how many children have been removed in front of it.
+    int _rowKey{-1};
+    int rowOf(const AbstractTreeItem* child) const;
+
     void removeChildLater(AbstractTreeItem* child);
     inline void checkForDeletion()
     {
@@ -49,3 +49,8 @@ QVariantList BacklogManager::requestBacklogAllFiltered(MsgId first, MsgId last,
     REQUEST(ARG(first), ARG(last), ARG(limit), ARG(additional), ARG(type), ARG(flags))
     return QVariantList();
 }
+
+void BacklogManager::requestBacklogBatch(QVariantList requests)
+{
+    REQUEST(ARG(requests))
+}
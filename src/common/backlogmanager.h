@@ -50,6 +50,39 @@ public slots:
         MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0, int type = -1, int flags = -1);
     inline virtual void receiveBacklogAll(MsgId, MsgId, int, int, QVariantList){};
     inline virtual void receiveBacklogAllFiltered(MsgId, MsgId, int, int, int, int, QVariantList){};
+    /**
+     * Marks the end of a requestBacklogAll() reply that was sent in several pages.
+     *
+     * The parameters echo those of the original request. No more receiveBacklogAll() calls follow for it.
+     *
+     * @note Requires Quassel::Feature::BacklogStreaming
+     */
+    inline virtual void receiveBacklogAllComplete(MsgId, MsgId, int, int){};
+    /**
+     * Marks the end of a requestBacklogAllFiltered() reply that was sent in several pages.
+     *
+     * @note Requires Quassel::Feature::BacklogStreaming
+     */
+    inline virtual void receiveBacklogAllFilteredComplete(MsgId, MsgId, int, int, int, int){};
+
+    /**
+     * Requests backlog for several buffers at once.
+     *
+     * Each entry of @p requests is a list of (BufferId, first MsgId, last MsgId, limit, additional), with the same
+     * semantics as the parameters of requestBacklog(). The core answers with one or more receiveBacklogBatch() calls,
+     * each of which carries the complete backlog for a subset of the requested buffers.
+     *
+     * @note Requires Quassel::Feature::BacklogBatchRequest
+     *
+     * @param requests Per-buffer backlog requests
+     */
+    virtual void requestBacklogBatch(QVariantList requests);
+    /**
+     * Receives backlog for a subset of the buffers of a batched request.
+     *
+     * @param backlogs List of (BufferId, list of messages) pairs
+     */
+    inline virtual void receiveBacklogBatch(QVariantList){};
 
 signals:
     void backlogRequested(BufferId, MsgId, MsgId, int, int);
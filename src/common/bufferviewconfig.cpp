@@ -105,6 +105,36 @@ QSet<BufferId> BufferViewConfig::temporarilyRemovedBuffers() const
     return _temporarilyRemovedBuffers;
 }
 
+int BufferViewConfig::bufferPosition(const BufferId& bufferId) const
+{
+    return _bufferPositions.value(bufferId, -1);
+}
+
+bool BufferViewConfig::containsBuffer(const BufferId& bufferId) const
+{
+    return _bufferPositions.contains(bufferId);
+}
+
+bool BufferViewConfig::isBufferRemoved(const BufferId& bufferId) const
+{
+    return _removedBuffers.contains(bufferId);
+}
+
+bool BufferViewConfig::isBufferTemporarilyRemoved(const BufferId& bufferId) const
+{
+    return _temporarilyRemovedBuffers.contains(bufferId);
+}
+
+void BufferViewConfig::updateBufferPositions(int from)
+{
+    if (from == 0)
+        _bufferPositions.clear();
+
+    for (int i = from; i < _buffers.count(); i++) {
+        _bufferPositions[_buffers.at(i)] = i;
+    }
+}
+
 QVariantList BufferViewConfig::initBufferList() const
 {
     QVariantList buffers;
@@ -123,6 +153,7 @@ void BufferViewConfig::initSetBufferList(const QVariantList& buffers)
     foreach (QVariant buffer, buffers) {
         _buffers << buffer.value<BufferId>();
     }
+    updateBufferPositions();
 
     emit configChanged();  // used to track changes in the settingspage
 }
@@ -271,12 +302,13 @@ void BufferViewConfig::setShowSearch(bool showSearch)
 void BufferViewConfig::setBufferList(const QList<BufferId>& buffers)
 {
     _buffers = buffers;
+    updateBufferPositions();
     emit configChanged();
 }
 
 void BufferViewConfig::addBuffer(const BufferId& bufferId, int pos)
 {
-    if (_buffers.contains(bufferId))
+    if (containsBuffer(bufferId))
         return;
 
     if (pos < 0)
@@ -291,6 +323,7 @@ void BufferViewConfig::addBuffer(const BufferId& bufferId, int pos)
         _temporarilyRemovedBuffers.remove(bufferId);
 
     _buffers.insert(pos, bufferId);
+    updateBufferPositions(pos);
     SYNC(ARG(bufferId), ARG(pos))
     emit bufferAdded(bufferId, pos);
     emit configChanged();
@@ -298,7 +331,7 @@ void BufferViewConfig::addBuffer(const BufferId& bufferId, int pos)
 
 void BufferViewConfig::moveBuffer(const BufferId& bufferId, int pos)
 {
-    if (!_buffers.contains(bufferId))
+    if (!containsBuffer(bufferId))
         return;
 
     if (pos < 0)
@@ -306,7 +339,9 @@ void BufferViewConfig::moveBuffer(const BufferId& bufferId, int pos)
     if (pos >= _buffers.count())
         pos = _buffers.count() - 1;
 
-    _buffers.move(_buffers.indexOf(bufferId), pos);
+    int oldPos = bufferPosition(bufferId);
+    _buffers.move(oldPos, pos);
+    updateBufferPositions(qMin(oldPos, pos));
     SYNC(ARG(bufferId), ARG(pos))
     emit bufferMoved(bufferId, pos);
     emit configChanged();
@@ -314,8 +349,11 @@ void BufferViewConfig::moveBuffer(const BufferId& bufferId, int pos)
 
 void BufferViewConfig::removeBuffer(const BufferId& bufferId)
 {
-    if (_buffers.contains(bufferId))
-        _buffers.removeAt(_buffers.indexOf(bufferId));
+    if (containsBuffer(bufferId)) {
+        int pos = _bufferPositions.take(bufferId);
+        _buffers.removeAt(pos);
+        updateBufferPositions(pos);
+    }
 
     if (_removedBuffers.contains(bufferId))
         _removedBuffers.remove(bufferId);
@@ -328,8 +366,11 @@ void BufferViewConfig::removeBuffer(const BufferId& bufferId)
 
 void BufferViewConfig::removeBufferPermanently(const BufferId& bufferId)
 {
-    if (_buffers.contains(bufferId))
-        _buffers.removeAt(_buffers.indexOf(bufferId));
+    if (containsBuffer(bufferId)) {
+        int pos = _bufferPositions.take(bufferId);
+        _buffers.removeAt(pos);
+        updateBufferPositions(pos);
+    }
 
     if (_temporarilyRemovedBuffers.contains(bufferId))
         _temporarilyRemovedBuffers.remove(bufferId);
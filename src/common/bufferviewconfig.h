@@ -22,6 +22,8 @@
 
 #include "common-export.h"
 
+#include <QHash>
+
 #include "bufferinfo.h"
 #include "syncableobject.h"
 #include "types.h"
@@ -63,6 +65,17 @@ public:
     QSet<BufferId> removedBuffers() const;
     QSet<BufferId> temporarilyRemovedBuffers() const;
 
+    /**
+     * Gets the position of a buffer within bufferList() in constant time
+     *
+     * @param bufferId ID of the buffer to look up
+     * @return Index of the buffer in bufferList(), or -1 if the buffer isn't part of this view
+     */
+    int bufferPosition(const BufferId& bufferId) const;
+    bool containsBuffer(const BufferId& bufferId) const;
+    bool isBufferRemoved(const BufferId& bufferId) const;
+    bool isBufferTemporarilyRemoved(const BufferId& bufferId) const;
+
 public slots:
     QVariantList initBufferList() const;
     void initSetBufferList(const QVariantList& buffers);
@@ -110,6 +123,13 @@ signals:
     void bufferPermanentlyRemoved(const BufferId& bufferId);
 
 private:
+    /**
+     * Updates the position index for all buffers from the given position on
+     *
+     * @param from First position in _buffers that changed
+     */
+    void updateBufferPositions(int from = 0);
+
     int _bufferViewId = 0;         ///< ID of the associated BufferView
     QString _bufferViewName = {};  ///< Display name of the associated BufferView
     NetworkId _networkId = {};     ///< Network ID this buffer belongs to
@@ -125,6 +145,7 @@ private:
     bool _showSearch = false;  ///< Persistently show the buffer search UI
 
     QList<BufferId> _buffers;
+    QHash<BufferId, int> _bufferPositions;  ///< Index of each buffer in _buffers, for fast lookups when sorting
     QSet<BufferId> _removedBuffers;
     QSet<BufferId> _temporarilyRemovedBuffers;
 };
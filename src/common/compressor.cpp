@@ -20,21 +20,443 @@
 
 #include "compressor.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <QDataStream>
+#include <QElapsedTimer>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QVariant>
+
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#    include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#    include <lz4frame.h>
+#endif
+
+#include "metrics.h"
 
 const int maxBufferSize = 64 * 1024 * 1024;  // protect us from zip bombs
 const int ioBufferSize = 64 * 1024;          // chunk size for inflate/deflate; should not be too large as we preallocate that space!
 
-Compressor::Compressor(QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent)
+/**
+ * Interface for the compression backends.
+ *
+ * A codec holds the compression and the decompression stream of a connection. Both operate on caller-provided buffers, so
+ * the Compressor can decompress straight into its read buffer.
+ */
+class Compressor::Codec
+{
+public:
+    enum Status
+    {
+        Ok,             ///< Some progress was made
+        NeedMoreInput,  ///< No progress possible without further input
+        Failed          ///< The stream is broken
+    };
+
+    virtual ~Codec() = default;
+
+    virtual bool init(CompressionLevel level) = 0;
+
+    /**
+     * Decompresses data from @a in into @a out.
+     *
+     * @param[out] inUsed  Number of input bytes consumed
+     * @param[out] outUsed Number of output bytes produced
+     */
+    virtual Status decompress(const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed) = 0;
+
+    /**
+     * Compresses data from @a in into @a out.
+     *
+     * If @a flush is set, the output is made decodable up to the end of the given input.
+     *
+     * @param[out] inUsed  Number of input bytes consumed
+     * @param[out] outUsed Number of output bytes produced
+     * @param[out] pending Whether the codec needs to be called again to produce the remaining output
+     */
+    virtual Status compress(
+        const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed, bool flush, bool& pending) = 0;
+};
+
+class Compressor::DeflateCodec : public Compressor::Codec
+{
+public:
+    ~DeflateCodec() override
+    {
+        // release resources allocated by zlib
+        if (_inflaterInitialized)
+            inflateEnd(&_inflater);
+        if (_deflaterInitialized)
+            deflateEnd(&_deflater);
+    }
+
+    bool init(CompressionLevel level) override
+    {
+        int zlevel;
+        switch (level) {
+        case BestCompression:
+            zlevel = 9;
+            break;
+        case BestSpeed:
+            zlevel = 1;
+            break;
+        default:
+            zlevel = Z_DEFAULT_COMPRESSION;
+        }
+
+        if (Z_OK != inflateInit(&_inflater)) {
+            qWarning() << "Could not initialize the inflate stream!";
+            return false;
+        }
+        _inflaterInitialized = true;
+
+        if (Z_OK != deflateInit(&_deflater, zlevel)) {
+            qWarning() << "Could not initialize the deflate stream!";
+            return false;
+        }
+        _deflaterInitialized = true;
+
+        return true;
+    }
+
+    Status decompress(const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed) override
+    {
+        // zlib doesn't modify the input, it just isn't declared const
+        _inflater.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(in));
+        _inflater.avail_in = static_cast<uInt>(inSize);
+        _inflater.next_out = reinterpret_cast<unsigned char*>(out);
+        _inflater.avail_out = static_cast<uInt>(outSize);
+
+        int status = inflate(&_inflater, Z_SYNC_FLUSH);  // get as much data as possible
+
+        inUsed = inSize - _inflater.avail_in;
+        outUsed = outSize - _inflater.avail_out;
+
+        switch (status) {
+        case Z_NEED_DICT:
+        case Z_DATA_ERROR:
+        case Z_MEM_ERROR:
+        case Z_STREAM_ERROR:
+            qWarning() << "Error while decompressing stream:" << status;
+            return Failed;
+        case Z_BUF_ERROR:
+            // means that we need more input to continue, so this is not an actual error
+            return NeedMoreInput;
+        case Z_STREAM_END:
+            qWarning() << "Reached end of zlib stream!";  // this should really never happen
+            return NeedMoreInput;
+        default:
+            // just try to get more out of the stream
+            return Ok;
+        }
+    }
+
+    Status compress(
+        const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed, bool flush, bool& pending) override
+    {
+        _deflater.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(in));
+        _deflater.avail_in = static_cast<uInt>(inSize);
+        _deflater.next_out = reinterpret_cast<unsigned char*>(out);
+        _deflater.avail_out = static_cast<uInt>(outSize);
+
+        int status = deflate(&_deflater, flush ? Z_PARTIAL_FLUSH : Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            qWarning() << "Error while compressing stream:" << status;
+            return Failed;
+        }
+
+        inUsed = inSize - _deflater.avail_in;
+        outUsed = outSize - _deflater.avail_out;
+        pending = _deflater.avail_out == 0;  // the output buffer being full is the only reason we should have to loop!
+        return Ok;
+    }
+
+private:
+    z_stream _inflater{};
+    z_stream _deflater{};
+    bool _inflaterInitialized{false};
+    bool _deflaterInitialized{false};
+};
+
+#ifdef HAVE_ZSTD
+
+namespace {
+
+/**
+ * Builds the dictionary both ends prime their zstd streams with.
+ *
+ * There are no recorded sessions to train a dictionary on, so this is raw content assembled from the protocol's vocabulary:
+ * init data keys and sync calls of the most common objects, serialized the way DataStreamPeer does. zstd finds matches close
+ * to the end of the dictionary more cheaply, so the most frequent messages come last.
+ *
+ * Both ends must use the exact same dictionary, so changing it requires a new connection feature!
+ */
+QByteArray buildZstdDictionary()
+{
+    // Message types as defined by DataStreamPeer
+    const qint16 syncMessage = 1;
+    const qint16 initDataMessage = 4;
+
+    QByteArray dictionary;
+    QDataStream stream(&dictionary, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_2);
+
+    // Users and channels are sent as maps of property name to the list of values for all objects
+    const QStringList userProperties{"user", "host", "nick", "realName", "account", "away", "awayMessage", "idleTime", "loginTime",
+                                     "server", "ircOperator", "lastAwayMessageTime", "whoisServiceReply", "suserHost", "encrypted",
+                                     "channels", "userModes"};
+    const QStringList channelProperties{"name", "topic", "password", "encrypted", "ChanModes", "UserModes"};
+    QVariantMap users;
+    for (const QString& property : userProperties)
+        users[property] = QVariantList{};
+    QVariantMap channels;
+    for (const QString& property : channelProperties)
+        channels[property] = QVariantList{};
+    QVariantMap usersAndChannels{{"Users", users}, {"Channels", channels}};
+    stream << (QVariantList() << initDataMessage << QByteArray("Network") << QByteArray("1")
+                              << (QVariantList() << QByteArray("IrcUsersAndChannels") << usersAndChannels));
+
+    const QList<QPair<QByteArray, QList<QByteArray>>> syncCalls{
+        {"Network", {"addSupport", "addCap", "acknowledgeCap", "setConnectionState", "setConnected", "setMyNick", "setLatency"}},
+        {"BufferSyncer", {"setMarkerLine", "setLastSeenMsg"}},
+        {"IrcChannel", {"setTopic", "addChannelMode", "removeChannelMode", "joinIrcUsers", "addUserMode", "removeUserMode"}},
+        {"Network", {"addIrcChannel", "addIrcUser"}},
+        {"IrcUser",
+         {"setUser", "setHost", "setRealName", "setAccount", "setServer", "setLoginTime", "setIdleTime", "addUserModes", "setNick",
+          "partChannel", "quit", "setAwayMessage", "setAway"}},
+    };
+    for (const auto& syncCall : syncCalls) {
+        for (const QByteArray& slotName : syncCall.second)
+            stream << (QVariantList() << syncMessage << syncCall.first << QByteArray("1/") << slotName);
+    }
+
+    return dictionary;
+}
+
+}  // namespace
+
+class Compressor::ZstdCodec : public Compressor::Codec
+{
+public:
+    ~ZstdCodec() override
+    {
+        ZSTD_freeCCtx(_cctx);
+        ZSTD_freeDCtx(_dctx);
+    }
+
+    bool init(CompressionLevel level) override
+    {
+        int zlevel;
+        switch (level) {
+        case BestCompression:
+            // Higher levels cost too much CPU for a live stream, considering that the core may serve many clients
+            zlevel = 9;
+            break;
+        case BestSpeed:
+            zlevel = 1;
+            break;
+        default:
+            zlevel = ZSTD_CLEVEL_DEFAULT;
+        }
+
+        _cctx = ZSTD_createCCtx();
+        // Limit the window size, as we need to keep one around per connection
+        if (!_cctx || ZSTD_isError(ZSTD_CCtx_setParameter(_cctx, ZSTD_c_compressionLevel, zlevel))
+            || ZSTD_isError(ZSTD_CCtx_setParameter(_cctx, ZSTD_c_windowLog, 20))) {
+            qWarning() << "Could not initialize the zstd compression stream!";
+            return false;
+        }
+
+        _dctx = ZSTD_createDCtx();
+        if (!_dctx || ZSTD_isError(ZSTD_DCtx_setParameter(_dctx, ZSTD_d_windowLogMax, 23))) {
+            qWarning() << "Could not initialize the zstd decompression stream!";
+            return false;
+        }
+
+        static const QByteArray dictionary = buildZstdDictionary();
+        if (ZSTD_isError(ZSTD_CCtx_loadDictionary(_cctx, dictionary.constData(), dictionary.size()))
+            || ZSTD_isError(ZSTD_DCtx_loadDictionary(_dctx, dictionary.constData(), dictionary.size()))) {
+            qWarning() << "Could not load the zstd dictionary!";
+            return false;
+        }
+
+        return true;
+    }
+
+    Status decompress(const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed) override
+    {
+        ZSTD_inBuffer input{in, inSize, 0};
+        ZSTD_outBuffer output{out, outSize, 0};
+
+        size_t result = ZSTD_decompressStream(_dctx, &output, &input);
+
+        inUsed = input.pos;
+        outUsed = output.pos;
+
+        if (ZSTD_isError(result)) {
+            qWarning() << "Error while decompressing stream:" << ZSTD_getErrorName(result);
+            return Failed;
+        }
+        return (inUsed || outUsed) ? Ok : NeedMoreInput;
+    }
+
+    Status compress(
+        const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed, bool flush, bool& pending) override
+    {
+        ZSTD_inBuffer input{in, inSize, 0};
+        ZSTD_outBuffer output{out, outSize, 0};
+
+        size_t result = ZSTD_compressStream2(_cctx, &output, &input, flush ? ZSTD_e_flush : ZSTD_e_continue);
+        if (ZSTD_isError(result)) {
+            qWarning() << "Error while compressing stream:" << ZSTD_getErrorName(result);
+            return Failed;
+        }
+
+        inUsed = input.pos;
+        outUsed = output.pos;
+        // When flushing, the result is the amount of data still buffered in the context
+        pending = input.pos < input.size || (flush && result > 0);
+        return Ok;
+    }
+
+private:
+    ZSTD_CCtx* _cctx{nullptr};
+    ZSTD_DCtx* _dctx{nullptr};
+};
+
+#endif
+
+#ifdef HAVE_LZ4
+
+class Compressor::Lz4Codec : public Compressor::Codec
+{
+public:
+    ~Lz4Codec() override
+    {
+        LZ4F_freeCompressionContext(_cctx);
+        LZ4F_freeDecompressionContext(_dctx);
+    }
+
+    bool init(CompressionLevel level) override
+    {
+        // The smallest block size keeps the per-connection buffers small; linked blocks still find matches in previous ones
+        _preferences.frameInfo.blockSizeID = LZ4F_max64KB;
+        _preferences.frameInfo.blockMode = LZ4F_blockLinked;
+        // Positive levels switch to LZ4 HC, which is only worth its CPU cost if asked for explicitly
+        _preferences.compressionLevel = level == BestCompression ? 9 : 0;
+
+        if (LZ4F_isError(LZ4F_createCompressionContext(&_cctx, LZ4F_VERSION))) {
+            qWarning() << "Could not initialize the LZ4 compression stream!";
+            return false;
+        }
+
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&_dctx, LZ4F_VERSION))) {
+            qWarning() << "Could not initialize the LZ4 decompression stream!";
+            return false;
+        }
+
+        return true;
+    }
+
+    Status decompress(const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed) override
+    {
+        inUsed = inSize;
+        outUsed = outSize;
+
+        size_t result = LZ4F_decompress(_dctx, out, &outUsed, in, &inUsed, nullptr);
+        if (LZ4F_isError(result)) {
+            qWarning() << "Error while decompressing stream:" << LZ4F_getErrorName(result);
+            return Failed;
+        }
+        return (inUsed || outUsed) ? Ok : NeedMoreInput;
+    }
+
+    Status compress(
+        const char* in, size_t inSize, size_t& inUsed, char* out, size_t outSize, size_t& outUsed, bool flush, bool& pending) override
+    {
+        inUsed = 0;
+
+        // LZ4F wants output space for the worst case of every call, which may exceed the caller's buffer.
+        // So we compress into a staging buffer, and hand out its contents over as many calls as needed.
+        if (_stagingPos == _staging.size()) {
+            size_t chunk = std::min(inSize, static_cast<size_t>(ioBufferSize));
+            _staging.resize(LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(chunk, &_preferences) + LZ4F_compressBound(0, &_preferences));
+            _stagingPos = 0;
+
+            size_t size = 0;
+            size_t result = 0;
+            if (!_frameStarted) {
+                result = LZ4F_compressBegin(_cctx, _staging.data(), _staging.size(), &_preferences);
+                if (LZ4F_isError(result)) {
+                    qWarning() << "Error while compressing stream:" << LZ4F_getErrorName(result);
+                    return Failed;
+                }
+                size += result;
+                _frameStarted = true;
+            }
+
+            if (chunk > 0) {
+                result = LZ4F_compressUpdate(_cctx, _staging.data() + size, _staging.size() - size, in, chunk, nullptr);
+                if (LZ4F_isError(result)) {
+                    qWarning() << "Error while compressing stream:" << LZ4F_getErrorName(result);
+                    return Failed;
+                }
+                size += result;
+                inUsed = chunk;
+            }
+
+            if (flush && inUsed == inSize) {
+                result = LZ4F_flush(_cctx, _staging.data() + size, _staging.size() - size, nullptr);
+                if (LZ4F_isError(result)) {
+                    qWarning() << "Error while compressing stream:" << LZ4F_getErrorName(result);
+                    return Failed;
+                }
+                size += result;
+            }
+
+            _staging.resize(size);  // keeps the capacity around for the next call
+        }
+
+        outUsed = std::min(outSize, _staging.size() - _stagingPos);
+        memcpy(out, _staging.data() + _stagingPos, outUsed);
+        _stagingPos += outUsed;
+
+        pending = _stagingPos < _staging.size() || inUsed < inSize;
+        return Ok;
+    }
+
+private:
+    LZ4F_cctx* _cctx{nullptr};
+    LZ4F_dctx* _dctx{nullptr};
+    LZ4F_preferences_t _preferences{};
+    bool _frameStarted{false};
+
+    std::vector<char> _staging;  ///< Compressed data not handed out yet
+    size_t _stagingPos{0};
+};
+
+#endif
+
+Compressor::Compressor(QTcpSocket* socket, Compressor::CompressionLevel level, Compressor::Algorithm algorithm, QObject* parent)
     : QObject(parent)
     , _socket(socket)
     , _level(level)
-    , _inflater(nullptr)
-    , _deflater(nullptr)
+    , _algorithm(algorithm)
 {
     connect(socket, &QIODevice::readyRead, this, &Compressor::readData);
 
+    // Reserving makes the buffers keep their capacity when emptied, so they aren't reallocated for every message
+    _readBuffer.reserve(ioBufferSize);
+    _writeBuffer.reserve(64);
+
     bool ok = true;
     if (level != NoCompression)
         ok = initStreams();
@@ -53,77 +475,120 @@ Compressor::Compressor(QTcpSocket* socket, Compressor::CompressionLevel level, Q
 
 Compressor::~Compressor()
 {
-    // release resources allocated by zlib
-    if (_inflater) {
-        inflateEnd(_inflater);
-        delete _inflater;
+    if (_codec) {
+        qDebug().nospace() << "Compression statistics: sent " << _statistics.rawBytesOut << " bytes as " << _statistics.compressedBytesOut
+                           << " (" << _statistics.compressionTimeNsec / 1000000 << " ms), received " << _statistics.rawBytesIn
+                           << " bytes as " << _statistics.compressedBytesIn << " (" << _statistics.decompressionTimeNsec / 1000000
+                           << " ms)";
     }
-    if (_deflater) {
-        deflateEnd(_deflater);
-        delete _deflater;
+}
+
+bool Compressor::isSupported(Compressor::Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Deflate:
+        return true;
+    case Zstd:
+#ifdef HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    case Lz4:
+#ifdef HAVE_LZ4
+        return true;
+#else
+        return false;
+#endif
     }
+    return false;
 }
 
 bool Compressor::initStreams()
 {
-    int zlevel;
-    switch (compressionLevel()) {
-    case BestCompression:
-        zlevel = 9;
+    std::unique_ptr<Codec> codec;
+    switch (algorithm()) {
+    case Zstd:
+#ifdef HAVE_ZSTD
+        codec.reset(new ZstdCodec);
         break;
-    case BestSpeed:
-        zlevel = 1;
+#else
+        qWarning() << "Zstandard compression is not supported by this build!";
+        return false;
+#endif
+    case Lz4:
+#ifdef HAVE_LZ4
+        codec.reset(new Lz4Codec);
         break;
-    default:
-        zlevel = Z_DEFAULT_COMPRESSION;
-    }
-
-    _inflater = new z_stream;
-    memset(_inflater, 0, sizeof(z_stream));
-    if (Z_OK != inflateInit(_inflater)) {
-        qWarning() << "Could not initialize the inflate stream!";
+#else
+        qWarning() << "LZ4 compression is not supported by this build!";
         return false;
+#endif
+    default:
+        codec.reset(new DeflateCodec);
     }
 
-    _deflater = new z_stream;
-    memset(_deflater, 0, sizeof(z_stream));
-    if (Z_OK != deflateInit(_deflater, zlevel)) {
-        qWarning() << "Could not initialize the deflate stream!";
+    if (!codec->init(compressionLevel()))
         return false;
-    }
+    _codec = std::move(codec);
 
     _inputBuffer.reserve(ioBufferSize);  // pre-allocate space
     _outputBuffer.resize(ioBufferSize);  // not a typo; we never change the size of this buffer anyway (we *do* for _inputBuffer!)
 
-    qDebug() << "Enabling compression...";
+    qDebug() << "Enabling" << (algorithm() == Zstd ? "zstd" : algorithm() == Lz4 ? "LZ4" : "deflate") << "compression...";
 
     return true;
 }
 
 qint64 Compressor::bytesAvailable() const
 {
-    return _readBuffer.size();
+    return _readBuffer.size() - _readPos;
 }
 
 qint64 Compressor::read(char* data, qint64 maxSize)
 {
     if (maxSize <= 0)
-        maxSize = _readBuffer.size();
+        maxSize = bytesAvailable();
+
+    qint64 n = qMin(maxSize, bytesAvailable());
+    memcpy(data, _readBuffer.constData() + _readPos, n);
+    consume(n);
+
+    return n;
+}
 
-    qint64 n = qMin(maxSize, (qint64)_readBuffer.size());
-    memcpy(data, _readBuffer.constData(), n);
+QByteArray Compressor::peek(qint64 size, QByteArray& buffer) const
+{
+    Q_ASSERT(size <= bytesAvailable());
+    buffer = _readBuffer;
+    return QByteArray::fromRawData(buffer.constData() + _readPos, static_cast<int>(size));
+}
 
-    // TODO: don't copy for every read
-    if (n == _readBuffer.size())
-        _readBuffer.clear();
-    else
-        _readBuffer = _readBuffer.mid(n);
+void Compressor::consume(qint64 size)
+{
+    _readPos += static_cast<int>(qMin(size, bytesAvailable()));
 
-    // If there's still data left in the socket buffer, make sure to schedule a read
-    if (_socket->bytesAvailable())
+    // Consumed data is only discarded lazily (see compactReadBuffer()), except if nothing is left anyway
+    if (_readPos == _readBuffer.size()) {
+        _readBuffer.resize(0);
+        _readPos = 0;
+    }
+
+    // If there's still data left in the socket buffer or the codec, make sure to schedule a read
+    if (_socket->bytesAvailable() || _inflatePending)
         QTimer::singleShot(0, this, &Compressor::readData);
+}
 
-    return n;
+void Compressor::compactReadBuffer()
+{
+    if (!_readPos)
+        return;
+
+    // Typically, all that's left at this point is the beginning of a partially received message
+    int remaining = _readBuffer.size() - _readPos;
+    memmove(_readBuffer.data(), _readBuffer.constData() + _readPos, remaining);
+    _readBuffer.resize(remaining);
+    _readPos = 0;
 }
 
 // The usual usage pattern is to write a blocksize first, followed by the actual data.
@@ -131,12 +596,19 @@ qint64 Compressor::read(char* data, qint64 maxSize)
 // written, which should make things a bit more efficient.
 qint64 Compressor::write(const char* data, qint64 count, WriteBufferHint flush)
 {
-    int pos = _writeBuffer.size();
-    _writeBuffer.resize(pos + count);
-    memcpy(_writeBuffer.data() + pos, data, count);
+    if (flush == NoFlush) {
+        _writeBuffer.append(data, static_cast<int>(count));
+        return count;
+    }
 
-    if (flush != NoFlush)
-        writeData();
+    if (!_writeBuffer.isEmpty()) {
+        bool ok = writeData(_writeBuffer.constData(), _writeBuffer.size(), false);
+        _writeBuffer.resize(0);
+        if (!ok)
+            return -1;
+    }
+    if (!writeData(data, count, true))
+        return -1;
 
     return count;
 }
@@ -147,105 +619,135 @@ void Compressor::readData()
     if (_socket->state() != QAbstractSocket::ConnectedState)
         return;
 
-    if (!_socket->bytesAvailable() || _readBuffer.size() >= maxBufferSize)
+    if ((!_socket->bytesAvailable() && !_inflatePending) || bytesAvailable() >= maxBufferSize)
         return;
 
+    compactReadBuffer();
+
     if (compressionLevel() == NoCompression) {
-        _readBuffer.append(_socket->read(maxBufferSize - _readBuffer.size()));
+        // Read straight into the buffer rather than through a temporary QByteArray
+        int pos = _readBuffer.size();
+        qint64 count = qMin(_socket->bytesAvailable(), static_cast<qint64>(maxBufferSize - pos));
+        _readBuffer.resize(pos + static_cast<int>(count));
+        qint64 bytesRead = _socket->read(_readBuffer.data() + pos, count);
+        _readBuffer.resize(pos + static_cast<int>(qMax(bytesRead, qint64{0})));
         emit readyRead();
         return;
     }
 
-    // We let zlib directly append to the readBuffer, which means we pre-allocate extra space for ioBufferSize.
+    if (!_codec)
+        return;  // initialization failed, and the error has already been reported
+
+    // We let the codec directly append to the readBuffer, which means we pre-allocate extra space for ioBufferSize.
     // Afterwards, we'll shrink the buffer appropriately. Since shrinking should not reallocate, the readBuffer's
     // capacity should over time adapt to the largest message sizes we encounter. However, this is not a bad thing
     // considering that otherwise (using an intermediate buffer) we'd copy around data for every single message.
     // TODO: Benchmark if it would still make sense to squeeze the buffer from time to time (e.g. after initial sync)!
 
-    while (_socket->bytesAvailable() && _readBuffer.size() + ioBufferSize < maxBufferSize && _inputBuffer.size() < ioBufferSize) {
-        _readBuffer.resize(_readBuffer.size() + ioBufferSize);
-        _inputBuffer.append(_socket->read(ioBufferSize - _inputBuffer.size()));
-
-        _inflater->next_in = reinterpret_cast<unsigned char*>(_inputBuffer.data());
-        _inflater->avail_in = _inputBuffer.size();
-        _inflater->next_out = reinterpret_cast<unsigned char*>(_readBuffer.data() + _readBuffer.size() - ioBufferSize);
-        _inflater->avail_out = ioBufferSize;
-
-        const unsigned char* orig_out = _inflater->next_out;  // so we see if we have actually produced any output
+    while ((_socket->bytesAvailable() || _inflatePending) && _readBuffer.size() + ioBufferSize < maxBufferSize) {
+        int inputSize = _inputBuffer.size();
+        if (inputSize < ioBufferSize) {
+            _inputBuffer.resize(ioBufferSize);
+            qint64 bytesRead = _socket->read(_inputBuffer.data() + inputSize, ioBufferSize - inputSize);
+            inputSize += static_cast<int>(qMax(bytesRead, qint64{0}));
+            _inputBuffer.resize(inputSize);
+        }
 
-        int status = inflate(_inflater, Z_SYNC_FLUSH);  // get as much data as possible
+        _readBuffer.resize(_readBuffer.size() + ioBufferSize);
+        char* out = _readBuffer.data() + _readBuffer.size() - ioBufferSize;
+
+        size_t inUsed = 0;
+        size_t outUsed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        Codec::Status status = _codec->decompress(_inputBuffer.constData(), inputSize, inUsed, out, ioBufferSize, outUsed);
+        const qint64 elapsed = timer.nsecsElapsed();
+        _statistics.decompressionTimeNsec += elapsed;
+        _statistics.compressedBytesIn += inUsed;
+        _statistics.rawBytesIn += outUsed;
+        Metrics::decompression().observe(elapsed);
+        Metrics::compressorWireBytes().add(inUsed);
+        Metrics::compressorRawBytes().add(outUsed);
 
         // adjust input and output buffers
-        _readBuffer.resize(_inflater->next_out - reinterpret_cast<unsigned char*>(_readBuffer.data()));
-        if (_inflater->avail_in > 0)
-            memmove(_inputBuffer.data(), _inflater->next_in, _inflater->avail_in);
-        _inputBuffer.resize(_inflater->avail_in);
+        _readBuffer.resize(_readBuffer.size() - ioBufferSize + static_cast<int>(outUsed));
+        if (inUsed > 0) {
+            int remaining = inputSize - static_cast<int>(inUsed);
+            memmove(_inputBuffer.data(), _inputBuffer.constData() + inUsed, remaining);
+            _inputBuffer.resize(remaining);
+        }
+
+        // If the output space ran out, the codec may still have data for us even if the socket is drained
+        _inflatePending = status == Codec::Ok && (outUsed == static_cast<size_t>(ioBufferSize) || !_inputBuffer.isEmpty());
 
-        if (_inflater->next_out != orig_out)
+        if (outUsed > 0)
             emit readyRead();
 
         switch (status) {
-        case Z_NEED_DICT:
-        case Z_DATA_ERROR:
-        case Z_MEM_ERROR:
-        case Z_STREAM_ERROR:
-            qWarning() << "Error while decompressing stream:" << status;
+        case Codec::Failed:
             emit error(StreamError);
             return;
-        case Z_BUF_ERROR:
-            // means that we need more input to continue, so this is not an actual error
-            return;
-        case Z_STREAM_END:
-            qWarning() << "Reached end of zlib stream!";  // this should really never happen
+        case Codec::NeedMoreInput:
             return;
-        default:
+        case Codec::Ok:
             // just try to get more out of the stream
             break;
         }
     }
-    // qDebug() << "inflate in:" << _inflater->total_in << "out:" << _inflater->total_out << "ratio:" << (double)_inflater->total_in/_inflater->total_out;
 }
 
-void Compressor::writeData()
+bool Compressor::writeData(const char* data, qint64 count, bool flush)
 {
     if (compressionLevel() == NoCompression) {
-        _socket->write(_writeBuffer);
-        _writeBuffer.clear();
-        return;
+        _socket->write(data, count);
+        return true;
     }
 
-    _deflater->next_in = reinterpret_cast<unsigned char*>(_writeBuffer.data());
-    _deflater->avail_in = _writeBuffer.size();
+    if (!_codec) {
+        emit error(StreamError);
+        return false;
+    }
 
-    int status;
+    size_t inPos = 0;
+    bool pending = false;
     do {
-        _deflater->next_out = reinterpret_cast<unsigned char*>(_outputBuffer.data());
-        _deflater->avail_out = ioBufferSize;
-        status = deflate(_deflater, Z_PARTIAL_FLUSH);
-        if (status != Z_OK && status != Z_BUF_ERROR) {
-            qWarning() << "Error while compressing stream:" << status;
+        size_t inUsed = 0;
+        size_t outUsed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        Codec::Status status = _codec->compress(
+            data + inPos, static_cast<size_t>(count) - inPos, inUsed, _outputBuffer.data(), ioBufferSize, outUsed, flush, pending);
+        const qint64 elapsed = timer.nsecsElapsed();
+        _statistics.compressionTimeNsec += elapsed;
+        Metrics::compression().observe(elapsed);
+        if (status == Codec::Failed) {
             emit error(StreamError);
-            return;
+            return false;
         }
 
-        if (_deflater->avail_out == static_cast<unsigned int>(ioBufferSize))
+        inPos += inUsed;
+        _statistics.compressedBytesOut += outUsed;
+        Metrics::compressorWireBytes().add(outUsed);
+
+        if (!outUsed)
             continue;  // nothing to write here
 
-        if (!_socket->write(_outputBuffer.constData(), ioBufferSize - _deflater->avail_out)) {
+        if (!_socket->write(_outputBuffer.constData(), static_cast<qint64>(outUsed))) {
             qWarning() << "Error while writing to socket:" << _socket->errorString();
             emit error(DeviceError);
-            return;
+            return false;
         }
-    } while (_deflater->avail_out == 0);  // the output buffer being full is the only reason we should have to loop here!
+    } while (pending);
 
-    if (_deflater->avail_in > 0) {
+    if (inPos < static_cast<size_t>(count)) {
         qWarning() << "Oops, something weird happened: data still remaining in write buffer!";
         emit error(StreamError);
+        return false;
     }
 
-    _writeBuffer.resize(0);
-
-    // qDebug() << "deflate in:" << _deflater->total_in << "out:" << _deflater->total_out << "ratio:" << (double)_deflater->total_out/_deflater->total_in;
+    _statistics.rawBytesOut += count;
+    Metrics::compressorRawBytes().add(count);
+    return true;
 }
 
 void Compressor::flush()
@@ -20,9 +20,9 @@
 
 #pragma once
 
-#include <QObject>
+#include <memory>
 
-#include <zlib.h>
+#include <QObject>
 
 class QTcpSocket;
 
@@ -39,6 +39,13 @@ public:
         BestSpeed
     };
 
+    enum Algorithm
+    {
+        Deflate,
+        Zstd,
+        Lz4
+    };
+
     enum Error
     {
         NoError,
@@ -52,14 +59,61 @@ public:
         Flush
     };
 
-    Compressor(QTcpSocket* socket, CompressionLevel level, QObject* parent = nullptr);
+    /**
+     * Per-connection compression statistics.
+     *
+     * Byte counts refer to the data passed through the compression backend, so they stay zero without compression.
+     */
+    struct Statistics
+    {
+        quint64 rawBytesIn{0};            ///< Decompressed bytes received
+        quint64 compressedBytesIn{0};     ///< Compressed bytes received
+        quint64 rawBytesOut{0};           ///< Uncompressed bytes sent
+        quint64 compressedBytesOut{0};    ///< Compressed bytes sent
+        qint64 decompressionTimeNsec{0};  ///< Time spent decompressing
+        qint64 compressionTimeNsec{0};    ///< Time spent compressing
+    };
+
+    Compressor(QTcpSocket* socket, CompressionLevel level, Algorithm algorithm = Deflate, QObject* parent = nullptr);
     ~Compressor() override;
 
+    /**
+     * Checks if the given compression algorithm is available in this build.
+     */
+    static bool isSupported(Algorithm algorithm);
+
     CompressionLevel compressionLevel() const { return _level; }
+    Algorithm algorithm() const { return _algorithm; }
+
+    const Statistics& statistics() const { return _statistics; }
 
     qint64 bytesAvailable() const;
 
     qint64 read(char* data, qint64 maxSize);
+
+    /**
+     * Returns a view of the next @a size bytes of decompressed data, without copying or removing them.
+     *
+     * @a buffer receives a shared reference to the underlying read buffer. As long as it is kept around, the view stays
+     * valid even if more data is read in the meantime, since the Compressor then detaches from the referenced buffer.
+     *
+     * @param size   Number of bytes to peek at; must not exceed bytesAvailable()
+     * @param buffer Keeps the viewed data alive
+     * @returns A QByteArray referencing the data without owning it
+     */
+    QByteArray peek(qint64 size, QByteArray& buffer) const;
+
+    /**
+     * Removes the next @a size bytes from the read buffer.
+     */
+    void consume(qint64 size);
+
+    /**
+     * Writes data to the socket, compressing it if enabled.
+     *
+     * Data written with the NoFlush hint is buffered and sent together with the next flushing write. Flushing writes are
+     * passed on to the socket or the deflate stream directly, without an intermediate copy.
+     */
     qint64 write(const char* data, qint64 count, WriteBufferHint flush = Flush);
 
     void flush();
@@ -72,19 +126,28 @@ private slots:
     void readData();
 
 private:
+    class Codec;
+    class DeflateCodec;
+    class ZstdCodec;
+    class Lz4Codec;
+
     bool initStreams();
-    void writeData();
+    void compactReadBuffer();
+    bool writeData(const char* data, qint64 count, bool flush);
 
 private:
     QTcpSocket* _socket;
     CompressionLevel _level;
+    Algorithm _algorithm;
 
     QByteArray _readBuffer;
+    int _readPos{0};  ///< Start of the unconsumed data in _readBuffer
     QByteArray _writeBuffer;
 
     QByteArray _inputBuffer;
     QByteArray _outputBuffer;
+    bool _inflatePending{false};  ///< The codec may still hold decompressed data that did not fit into the read buffer
 
-    z_streamp _inflater;
-    z_streamp _deflater;
+    std::unique_ptr<Codec> _codec;
+    Statistics _statistics;
 };
@@ -20,12 +20,17 @@
 
 #include "eventmanager.h"
 
+#include <algorithm>
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QEvent>
+#include <QHash>
+#include <QVarLengthArray>
 
 #include "event.h"
 #include "ircevent.h"
+#include "metrics.h"
 
 // ============================================================
 //  QueuedEvent
@@ -64,6 +69,37 @@ EventManager::EventType EventManager::eventTypeByName(const QString& name)
     return (val == -1) ? Invalid : static_cast<EventType>(val);
 }
 
+EventManager::EventType EventManager::ircEventTypeByCommand(const QString& command)
+{
+    // Built once from the EventType enum, so that new IrcEvent types are picked up automatically.
+    // Only types named like "IrcEventPrivmsg" correspond to a command; internal types such as IrcEventRawPrivmsg
+    // must never be reachable from the wire, as their handlers expect a different event class.
+    static const QHash<QString, EventType> commandTypes = [] {
+        QHash<QString, EventType> types;
+        const QMetaEnum metaEnum = eventEnum();
+        const QLatin1String prefix{"IrcEvent"};
+        for (int i = 0; i < metaEnum.keyCount(); ++i) {
+            QString key = QString::fromLatin1(metaEnum.key(i));
+            auto type = static_cast<EventType>(metaEnum.value(i));
+            if ((type & EventGroupMask) != IrcEvent || type == IrcEventNumeric || type == IrcEventUnknown)
+                continue;
+            if (!key.startsWith(prefix) || key.size() <= prefix.size())
+                continue;
+            QString command = key.mid(prefix.size());
+            if (command != command.left(1).toUpper() + command.mid(1).toLower())
+                continue;
+            types.insert(command.toUpper(), type);
+        }
+        return types;
+    }();
+
+    // Servers send commands in upper case, so only normalize if that doesn't match
+    auto it = commandTypes.constFind(command);
+    if (it == commandTypes.constEnd())
+        it = commandTypes.constFind(command.toUpper());
+    return it == commandTypes.constEnd() ? Invalid : *it;
+}
+
 EventManager::EventType EventManager::eventGroupByName(const QString& name)
 {
     EventType type = eventTypeByName(name);
@@ -154,6 +190,7 @@ void EventManager::registerObject(QObject* object, Priority priority, const QStr
             // qDebug() << "Registered event filterer for" << methodSignature << "in" << object;
         }
     }
+    invalidateDispatchTables();
 }
 
 void EventManager::registerEventFilter(EventType event, QObject* object, const char* slot)
@@ -189,6 +226,7 @@ void EventManager::registerEventHandler(QList<EventType> events, QObject* object
             qDebug() << "Registered event handler for" << event << "in" << object;
         }
     }
+    invalidateDispatchTables();
 }
 
 void EventManager::postEvent(Event* event)
@@ -218,6 +256,7 @@ void EventManager::customEvent(QEvent* event)
 void EventManager::processEvent(Event* event)
 {
     Q_ASSERT(_eventQueue.isEmpty());
+    Metrics::ScopedTimer timer(Metrics::eventDispatch());
     dispatchEvent(event);
     // dispatching the event might cause new events to be generated. we process those afterwards.
     while (!_eventQueue.isEmpty()) {
@@ -230,15 +269,8 @@ void EventManager::dispatchEvent(Event* event)
 {
     // qDebug() << "Dispatching" << event;
 
-    // we try handlers from specialized to generic by masking the enum
-
-    // build a list sorted by priorities that contains all eligible handlers
-    QList<Handler> handlers;
-    QHash<QObject*, Handler> filters;
-    QSet<QObject*> ignored;
     uint type = event->type();
-
-    bool checkDupes = false;
+    int num = 0;
 
     // special handling for numeric IrcEvents
     if ((type & ~IrcEventNumericMask) == IrcEventNumeric) {
@@ -246,54 +278,108 @@ void EventManager::dispatchEvent(Event* event)
         if (!numEvent)
             qWarning() << "Invalid event type for IrcEventNumeric!";
         else {
-            int num = numEvent->number();
-            if (num > 0) {
-                insertHandlers(registeredHandlers().value(type + num), handlers, false);
-                insertFilters(registeredFilters().value(type + num), filters);
-                checkDupes = true;
-            }
+            int number = numEvent->number();
+            if (number > 0)
+                num = number;
         }
     }
 
-    // exact type
-    insertHandlers(registeredHandlers().value(type), handlers, checkDupes);
-    insertFilters(registeredFilters().value(type), filters);
-
-    // check if we have a generic handler for the event group
-    if ((type & EventGroupMask) != type) {
-        insertHandlers(registeredHandlers().value(type & EventGroupMask), handlers, true);
-        insertFilters(registeredFilters().value(type & EventGroupMask), filters);
+    if (_dispatchTablesDirty && !_dispatchDepth) {
+        _dispatchTables.clear();
+        _dispatchTablesDirty = false;
     }
+    ++_dispatchDepth;
+
+    // objects whose filter rejected the event; there are only ever a handful
+    QVarLengthArray<QObject*, 8> ignored;
 
     // now dispatch the event
-    QList<Handler>::const_iterator it;
-    for (it = handlers.begin(); it != handlers.end() && !event->isStopped(); ++it) {
-        QObject* obj = it->object;
+    for (const DispatchEntry& entry : dispatchTable(type, num)) {
+        if (event->isStopped())
+            break;
 
-        if (ignored.contains(obj))  // object has filtered the event
+        QObject* obj = entry.object;
+        if (std::find(ignored.cbegin(), ignored.cend(), obj) != ignored.cend())  // object has filtered the event
             continue;
 
-        if (filters.contains(obj)) {  // we have a filter, so let's check if we want to deliver the event
-            Handler filter = filters.value(obj);
+        if (entry.filterIndex >= 0) {  // we have a filter, so let's check if we want to deliver the event
             bool result = false;
             void* param[] = {Q_RETURN_ARG(bool, result).data(), Q_ARG(Event*, event).data()};
-            obj->qt_metacall(QMetaObject::InvokeMetaMethod, filter.methodIndex, param);
+            obj->qt_metacall(QMetaObject::InvokeMetaMethod, entry.filterIndex, param);
             if (!result) {
-                ignored.insert(obj);
+                ignored.append(obj);
                 continue;  // mmmh, event filter told us to not accept
             }
         }
 
         // finally, deliverance!
         void* param[] = {nullptr, Q_ARG(Event*, event).data()};
-        obj->qt_metacall(QMetaObject::InvokeMetaMethod, it->methodIndex, param);
+        obj->qt_metacall(QMetaObject::InvokeMetaMethod, entry.methodIndex, param);
     }
 
+    --_dispatchDepth;
+
     // that's it
     delete event;
 }
 
-void EventManager::insertHandlers(const QList<Handler>& newHandlers, QList<Handler>& existing, bool checkDupes)
+const EventManager::DispatchTable& EventManager::dispatchTable(uint type, int num)
+{
+    quint64 key = (static_cast<quint64>(num) << 32) | type;
+    auto it = _dispatchTables.find(key);
+    if (it == _dispatchTables.end())
+        it = _dispatchTables.emplace(key, buildDispatchTable(type, num)).first;
+    return it->second;
+}
+
+EventManager::DispatchTable EventManager::buildDispatchTable(uint type, int num) const
+{
+    // we try handlers from specialized to generic by masking the enum
+
+    // build a list sorted by priorities that contains all eligible handlers
+    QList<Handler> handlers;
+    QHash<QObject*, Handler> filters;
+
+    bool checkDupes = false;
+
+    // numeric IrcEvents
+    if (num > 0) {
+        insertHandlers(registeredHandlers().value(type + num), handlers, false);
+        insertFilters(registeredFilters().value(type + num), filters);
+        checkDupes = true;
+    }
+
+    // exact type
+    insertHandlers(registeredHandlers().value(type), handlers, checkDupes);
+    insertFilters(registeredFilters().value(type), filters);
+
+    // check if we have a generic handler for the event group
+    if ((type & EventGroupMask) != type) {
+        insertHandlers(registeredHandlers().value(type & EventGroupMask), handlers, true);
+        insertFilters(registeredFilters().value(type & EventGroupMask), filters);
+    }
+
+    DispatchTable table;
+    table.reserve(handlers.size());
+    for (const Handler& handler : handlers) {
+        auto filter = filters.constFind(handler.object);
+        table.push_back({handler.object, handler.methodIndex, filter != filters.constEnd() ? filter->methodIndex : -1});
+    }
+    return table;
+}
+
+void EventManager::invalidateDispatchTables()
+{
+    // tables may still be in use by an ongoing dispatch, in which case they are dropped once it's done
+    if (_dispatchDepth) {
+        _dispatchTablesDirty = true;
+        return;
+    }
+    _dispatchTables.clear();
+    _dispatchTablesDirty = false;
+}
+
+void EventManager::insertHandlers(const QList<Handler>& newHandlers, QList<Handler>& existing, bool checkDupes) const
 {
     foreach (const Handler& handler, newHandlers) {
         if (existing.isEmpty())
@@ -321,7 +407,7 @@ void EventManager::insertHandlers(const QList<Handler>& newHandlers, QList<Handl
 
 // priority is ignored, and only the first (should be most specialized) filter is being used
 // fun things could happen if you used the registerEventFilter() methods in the wrong order though
-void EventManager::insertFilters(const QList<Handler>& newFilters, QHash<QObject*, Handler>& existing)
+void EventManager::insertFilters(const QList<Handler>& newFilters, QHash<QObject*, Handler>& existing) const
 {
     foreach (const Handler& filter, newFilters) {
         if (!existing.contains(filter.object))
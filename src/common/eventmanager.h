@@ -22,6 +22,9 @@
 
 #include "common-export.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include <QMetaEnum>
 
 #include "types.h"
@@ -131,6 +134,13 @@ public:
 
     static EventType eventTypeByName(const QString& name);
     static EventType eventGroupByName(const QString& name);
+    /**
+     * Get the IrcEvent type for a (non-numeric) IRC command, e.g. IrcEventPrivmsg for "PRIVMSG".
+     *
+     * @param command IRC command, matched case-insensitively
+     * @return The matching IrcEvent type, or Invalid if there is none
+     */
+    static EventType ircEventTypeByCommand(const QString& command);
     static QString enumName(EventType type);
     static QString enumName(int type);  // for sanity tests
 
@@ -176,6 +186,15 @@ private:
 
     using HandlerHash = QHash<uint, QList<Handler>>;
 
+    //! A handler as called by dispatchEvent(), together with its object's filter for the event type, if any
+    struct DispatchEntry
+    {
+        QObject* object;
+        int methodIndex;
+        int filterIndex;  ///< -1 if there is no filter
+    };
+    using DispatchTable = std::vector<DispatchEntry>;
+
     inline const HandlerHash& registeredHandlers() const { return _registeredHandlers; }
     inline HandlerHash& registeredHandlers() { return _registeredHandlers; }
 
@@ -183,12 +202,18 @@ private:
     inline HandlerHash& registeredFilters() { return _registeredFilters; }
 
     //! Add handlers to an existing sorted (by priority) handler list
-    void insertHandlers(const QList<Handler>& newHandlers, QList<Handler>& existing, bool checkDupes = false);
+    void insertHandlers(const QList<Handler>& newHandlers, QList<Handler>& existing, bool checkDupes = false) const;
     //! Add filters to an existing filter hash
-    void insertFilters(const QList<Handler>& newFilters, QHash<QObject*, Handler>& existing);
+    void insertFilters(const QList<Handler>& newFilters, QHash<QObject*, Handler>& existing) const;
 
     int findEventType(const QString& methodSignature, const QString& methodPrefix) const;
 
+    //! Returns the dispatch table for the given event type and numeric, building it on first use
+    const DispatchTable& dispatchTable(uint type, int num);
+    DispatchTable buildDispatchTable(uint type, int num) const;
+    //! Discards all dispatch tables, to be called whenever handlers or filters are registered
+    void invalidateDispatchTables();
+
     void processEvent(Event* event);
     void dispatchEvent(Event* event);
 
@@ -197,6 +222,10 @@ private:
 
     HandlerHash _registeredHandlers;
     HandlerHash _registeredFilters;
+    // Keyed by (numeric << 32 | type); node-based, so references stay valid while nested dispatches add tables
+    std::unordered_map<quint64, DispatchTable> _dispatchTables;
+    int _dispatchDepth{0};
+    bool _dispatchTablesDirty{false};
     QList<Event*> _eventQueue;
     static QMetaEnum _enum;
 };
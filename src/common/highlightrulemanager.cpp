@@ -138,6 +138,8 @@ bool HighlightRuleManager::match(const NetworkId& netId,
     }
 
     bool matches = false;
+    // Strip once for all rules and the nick matcher
+    const QString strippedContents = stripFormatCodes(msgContents);
 
     for (int i = 0; i < _highlightRuleList.count(); i++) {
         auto& rule = _highlightRuleList.at(i);
@@ -157,7 +159,7 @@ bool HighlightRuleManager::match(const NetworkId& netId,
         }
 
         // Check message according to specified rule, allowing empty rules to match
-        bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
+        bool contentsMatch = rule.contentsMatcher().match(strippedContents, true);
 
         // Check sender according to specified rule, allowing empty rules to match
         bool senderMatch = rule.senderMatcher().match(msgSender, true);
@@ -180,7 +182,7 @@ bool HighlightRuleManager::match(const NetworkId& netId,
     if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
         // Nickname matching allowed and current nickname is known
         // Run the nickname matcher on the unformatted string
-        if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
+        if (_nickMatcher.match(strippedContents, netId, currentNick, identityNicks)) {
             return true;
         }
     }
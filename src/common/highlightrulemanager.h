@@ -239,7 +239,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch contentsMatcher() const
+        inline const ExpressionMatch& contentsMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -252,7 +252,7 @@ public:
          *
          * @return Expression matcher to compare with message sender
          */
-        inline ExpressionMatch senderMatcher() const
+        inline const ExpressionMatch& senderMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -265,7 +265,7 @@ public:
          *
          * @return Expression matcher to compare with channel name
          */
-        inline ExpressionMatch chanNameMatcher() const
+        inline const ExpressionMatch& chanNameMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
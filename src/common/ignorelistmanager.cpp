@@ -127,7 +127,12 @@ IgnoreListManager::StrictnessType IgnoreListManager::_match(
     if (!(msgType & (Message::Plain | Message::Notice | Message::Action)))
         return UnmatchedStrictness;
 
-    foreach (IgnoreListItem item, _ignoreList) {
+    // Only strip the message once, no matter how many rules look at it
+    QString strippedContents;
+    bool contentsStripped = false;
+
+    // Iterate by reference, so the expressions compiled by each item are kept for the next message
+    for (const IgnoreListItem& item : _ignoreList) {
         if (!item.isEnabled() || item.type() == CtcpIgnore)
             continue;
         if (item.scope() == GlobalScope || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))
@@ -135,7 +140,11 @@ IgnoreListManager::StrictnessType IgnoreListManager::_match(
             QString str;
             if (item.type() == MessageIgnore) {
                 // TODO: Make this configurable?  Pre-0.14, format codes were not removed
-                str = stripFormatCodes(msgContents);
+                if (!contentsStripped) {
+                    strippedContents = stripFormatCodes(msgContents);
+                    contentsStripped = true;
+                }
+                str = strippedContents;
             } else {
                 str = msgSender;
             }
@@ -170,7 +179,7 @@ void IgnoreListManager::toggleIgnoreRule(const QString& ignoreRule)
 
 bool IgnoreListManager::ctcpMatch(const QString sender, const QString& network, const QString& type)
 {
-    foreach (IgnoreListItem item, _ignoreList) {
+    for (const IgnoreListItem& item : _ignoreList) {
         if (!item.isEnabled())
             continue;
         if (item.scope() == GlobalScope || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))) {
@@ -269,7 +269,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch contentsMatcher() const
+        inline const ExpressionMatch& contentsMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -282,7 +282,7 @@ public:
          *
          * @return Expression matcher to compare with scope
          */
-        inline ExpressionMatch scopeRuleMatcher() const
+        inline const ExpressionMatch& scopeRuleMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -295,7 +295,7 @@ public:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch senderCTCPMatcher() const
+        inline const ExpressionMatch& senderCTCPMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -88,6 +88,11 @@ int InternalPeer::lag() const
     return 0;
 }
 
+qint64 InternalPeer::bytesToWrite() const
+{
+    return 0;
+}
+
 ::SignalProxy* InternalPeer::signalProxy() const
 {
     return _proxy;
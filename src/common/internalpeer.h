@@ -55,6 +55,8 @@ public:
 
     int lag() const override;
 
+    qint64 bytesToWrite() const override;
+
     void dispatch(const Protocol::SyncMessage& msg) override;
     void dispatch(const Protocol::RpcCall& msg) override;
     void dispatch(const Protocol::InitRequest& msg) override;
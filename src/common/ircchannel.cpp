@@ -177,9 +177,8 @@ void IrcChannel::joinIrcUsers(const QList<IrcUser*>& users, const QStringList& m
             continue;
         }
 
-        _userModes[ircuser] = sortedModes[i];
+        _userModes[ircuser] = network()->internString(sortedModes[i]);
         ircuser->joinChannel(this, true);
-        connect(ircuser, &IrcUser::nickSet, this, selectOverload<QString>(&IrcChannel::ircUserNickSet));
 
         // connect(ircuser, SIGNAL(destroyed()), this, SLOT(ircUserDestroyed()));
         // If you wonder why there is no counterpart to ircUserJoined:
@@ -218,6 +217,7 @@ void IrcChannel::part(IrcUser* ircuser)
 {
     if (isKnownUser(ircuser)) {
         _userModes.remove(ircuser);
+        network()->invalidateIrcUsersAndChannelsSnapshot();
         ircuser->partChannel(this);
         // If you wonder why there is no counterpart to ircUserParted:
         // the joins are propagted by the ircuser. The signal ircUserParted is only for convenience
@@ -249,7 +249,7 @@ void IrcChannel::setUserModes(IrcUser* ircuser, const QString& modes)
 {
     if (isKnownUser(ircuser)) {
         // Keep user modes sorted
-        _userModes[ircuser] = network()->sortPrefixModes(modes);
+        _userModes[ircuser] = network()->internString(network()->sortPrefixModes(modes));
         QString nick = ircuser->nick();
         SYNC_OTHER(setUserModes, ARG(nick), ARG(modes))
         emit ircUserModesSet(ircuser, modes);
@@ -269,7 +269,7 @@ void IrcChannel::addUserMode(IrcUser* ircuser, const QString& mode)
 
     if (!_userModes[ircuser].contains(mode)) {
         // Keep user modes sorted
-        _userModes[ircuser] = network()->sortPrefixModes(_userModes[ircuser] + mode);
+        _userModes[ircuser] = network()->internString(network()->sortPrefixModes(_userModes[ircuser] + mode));
         QString nick = ircuser->nick();
         SYNC_OTHER(addUserMode, ARG(nick), ARG(mode))
         emit ircUserModeAdded(ircuser, mode);
@@ -289,7 +289,7 @@ void IrcChannel::removeUserMode(IrcUser* ircuser, const QString& mode)
 
     if (_userModes[ircuser].contains(mode)) {
         // Removing modes shouldn't mess up ordering
-        _userModes[ircuser].remove(mode);
+        _userModes[ircuser] = network()->internString(QString(_userModes[ircuser]).remove(mode));
         QString nick = ircuser->nick();
         SYNC_OTHER(removeUserMode, ARG(nick), ARG(mode));
         emit ircUserModeRemoved(ircuser, mode);
@@ -400,15 +400,16 @@ void IrcChannel::ircUserDestroyed()
     auto* ircUser = static_cast<IrcUser*>(sender());
     Q_ASSERT(ircUser);
     _userModes.remove(ircUser);
+    if (_network)
+        _network->invalidateIrcUsersAndChannelsSnapshot();
     // no further propagation.
     // this leads only to fuck ups.
 }
 
-void IrcChannel::ircUserNickSet(QString nick)
+void IrcChannel::syncCalled() const
 {
-    auto* ircUser = qobject_cast<IrcUser*>(sender());
-    Q_ASSERT(ircUser);
-    emit ircUserNickSet(ircUser, nick);
+    if (_network)
+        _network->invalidateIrcUsersAndChannelsSnapshot();
 }
 
 /*******************************************************************************
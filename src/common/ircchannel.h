@@ -127,9 +127,11 @@ signals:
 
     void parted();  // convenience signal emitted before channels destruction
 
+protected:
+    void syncCalled() const override;
+
 private slots:
     void ircUserDestroyed();
-    void ircUserNickSet(QString nick);
 
 private:
     bool _initialized;
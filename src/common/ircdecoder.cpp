@@ -20,13 +20,33 @@
 
 #include "ircdecoder.h"
 
+#include <cstring>
+
 #include <QDebug>
 
 #include "irctag.h"
 
+namespace {
+
+// Position of the first c in raw[from, to), or to if there is none
+int indexIn(const QByteArray& raw, char c, int from, int to)
+{
+    if (from >= to)
+        return to;
+    auto found = static_cast<const char*>(std::memchr(raw.constData() + from, c, static_cast<size_t>(to - from)));
+    return found ? static_cast<int>(found - raw.constData()) : to;
+}
+
+}  // namespace
+
 QString IrcDecoder::parseTagValue(const QString& value)
 {
+    // Most values don't contain escape sequences at all
+    if (!value.contains('\\'))
+        return value;
+
     QString result;
+    result.reserve(value.size());
     bool escaped = false;
     for (auto it = value.begin(); it < value.end(); it++) {
         // Check if it's on the list of special wildcard characters, converting to Unicode for use
@@ -100,66 +120,82 @@ void IrcDecoder::skipEmptyParts(const QByteArray& raw, int& start)
     }
 }
 
-QHash<IrcTagKey, QString> IrcDecoder::parseTags(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start)
+QHash<IrcTagKey, QString> IrcDecoder::decodeTags(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, const Span& span)
 {
-    QHash<IrcTagKey, QString> tags = {};
-    QString rawTagStr = decode(extractFragment(raw, start, -1, '@'));
+    QHash<IrcTagKey, QString> tags;
+    const int end = span.start + span.length;
     // Tags are delimited with ; according to spec
-    QList<QString> rawTags = rawTagStr.split(';');
-    for (const QString& rawTag : rawTags) {
-        if (rawTag.isEmpty()) {
-            continue;
-        }
+    for (int pos = span.start; pos < end;) {
+        int tagEnd = indexIn(raw, ';', pos, end);
+        if (tagEnd > pos) {
+            int keyEnd = indexIn(raw, '=', pos, tagEnd);
 
-        QString rawKey;
-        QString rawValue;
-        int index = rawTag.indexOf('=');
-        if (index == -1 || index == rawTag.length()) {
-            rawKey = rawTag;
-        }
-        else {
-            rawKey = rawTag.left(index);
-            rawValue = rawTag.mid(index + 1);
-        }
+            IrcTagKey key{};
+            int keyStart = pos;
+            key.clientTag = raw[keyStart] == '+';
+            if (key.clientTag) {
+                keyStart++;
+            }
 
-        IrcTagKey key{};
-        key.clientTag = rawKey.startsWith('+');
-        if (key.clientTag) {
-            rawKey.remove(0, 1);
-        }
+            QString rawKey = decode(raw.mid(keyStart, keyEnd - keyStart));
+            int splitIndex = rawKey.lastIndexOf('/');
+            if (splitIndex > 0 && splitIndex + 1 < rawKey.length()) {
+                key.key = rawKey.mid(splitIndex + 1);
+                key.vendor = rawKey.left(splitIndex);
+            }
+            else {
+                key.key = rawKey;
+            }
 
-        int splitIndex = rawKey.lastIndexOf('/');
-        if (splitIndex > 0 && splitIndex + 1 < rawKey.length()) {
-            key.key = rawKey.mid(splitIndex + 1);
-            key.vendor = rawKey.left(splitIndex);
-        }
-        else {
-            key.key = rawKey;
+            if (keyEnd < tagEnd) {
+                tags[key] = parseTagValue(decode(raw.mid(keyEnd + 1, tagEnd - keyEnd - 1)));
+            }
+            else {
+                tags[key] = QString();
+            }
         }
-        tags[key] = parseTagValue(rawValue);
+        pos = tagEnd + 1;
     }
     return tags;
 }
 
-QString IrcDecoder::parsePrefix(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start)
+void IrcDecoder::tokenize(const QByteArray& raw, Tokens& tokens)
 {
-    return decode(extractFragment(raw, start, -1, ':'));
-}
+    tokens.tags = {};
+    tokens.prefix = {};
+    tokens.parameters.clear();
 
-QString IrcDecoder::parseCommand(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start)
-{
-    return decode(extractFragment(raw, start, -1));
-}
+    const int size = raw.size();
+    int start = 0;
+    // Returns the fragment up to the next space, skipping the given number of leading characters
+    auto nextFragment = [&](int skip) {
+        int end = indexIn(raw, ' ', start, size);
+        Span span{start + skip, end - start - skip};
+        start = end;
+        return span;
+    };
 
-QByteArray IrcDecoder::parseParameter(const QByteArray& raw, int& start)
-{
-    if (start < raw.length() && raw[start] == ':') {
-        // Skip the prefix
-        start++;
-        return extractFragment(raw, start, raw.size());
+    skipEmptyParts(raw, start);
+    if (start < size && raw[start] == '@') {
+        tokens.tags = nextFragment(1);
+        skipEmptyParts(raw, start);
     }
-    else {
-        return extractFragment(raw, start);
+    if (start < size && raw[start] == ':') {
+        tokens.prefix = nextFragment(1);
+        skipEmptyParts(raw, start);
+    }
+    tokens.command = nextFragment(0);
+    skipEmptyParts(raw, start);
+    while (start < size) {
+        if (raw[start] == ':') {
+            // Trailing parameter, spans the remainder of the message
+            tokens.parameters.append(Span{start + 1, size - start - 1});
+            start = size;
+        }
+        else {
+            tokens.parameters.append(nextFragment(0));
+            skipEmptyParts(raw, start);
+        }
     }
 }
 
@@ -170,19 +206,19 @@ void IrcDecoder::parseMessage(const std::function<QString(const QByteArray&)>& d
                               QString& command,
                               QList<QByteArray>& parameters)
 {
-    int start = 0;
-    skipEmptyParts(rawMsg, start);
-    tags = parseTags(decode, rawMsg, start);
-    skipEmptyParts(rawMsg, start);
-    prefix = parsePrefix(decode, rawMsg, start);
-    skipEmptyParts(rawMsg, start);
-    command = parseCommand(decode, rawMsg, start);
-    skipEmptyParts(rawMsg, start);
-    QList<QByteArray> params;
-    while (start != rawMsg.length()) {
-        QByteArray param = parseParameter(rawMsg, start);
-        skipEmptyParts(rawMsg, start);
-        params.append(param);
+    Tokens tokens;
+    tokenize(rawMsg, tokens);
+
+    if (tokens.tags.isEmpty())
+        tags.clear();
+    else
+        tags = decodeTags(decode, rawMsg, tokens.tags);
+    prefix = decode(fragment(rawMsg, tokens.prefix));
+    command = decode(fragment(rawMsg, tokens.command));
+
+    parameters.clear();
+    parameters.reserve(tokens.parameters.size());
+    for (const Span& span : tokens.parameters) {
+        parameters.append(fragment(rawMsg, span));
     }
-    parameters = params;
 }
@@ -24,11 +24,39 @@
 
 #include <functional>
 
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVarLengthArray>
+
 #include "irctag.h"
 
 class COMMON_EXPORT IrcDecoder
 {
 public:
+    /**
+     * Location of a fragment within a raw IRC message
+     */
+    struct Span
+    {
+        int start = 0;
+        int length = 0;
+
+        bool isEmpty() const { return length == 0; }
+    };
+
+    /**
+     * Locations of the parts of a raw IRC message, as determined by tokenize()
+     */
+    struct Tokens
+    {
+        Span tags;     ///< IRCv3 message tags, without the leading '@'
+        Span prefix;   ///< Prefix, without the leading ':'
+        Span command;  ///< Named command or numeric RPL
+        QVarLengthArray<Span, 16> parameters;  ///< Parameters, trailing parameter without the leading ':'
+    };
+
     /**
      * Parses an IRC message
      * @param decode Decoder to be used for decoding the message
@@ -40,6 +68,32 @@ public:
      */
     static void parseMessage(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, QHash<IrcTagKey, QString>& tags, QString& prefix, QString& command, QList<QByteArray>& parameters);
 
+    /**
+     * Splits an IRC message into its parts in a single pass, without copying or decoding anything
+     *
+     * Use fragment() and decodeTags() to get at the parts that are actually needed.
+     * @param raw Raw Message
+     * @param tokens[out] Locations of the message parts within raw
+     */
+    static void tokenize(const QByteArray& raw, Tokens& tokens);
+
+    /**
+     * Returns a copy of a fragment of an IRC message
+     * @param raw Raw Message, as passed to tokenize()
+     * @param span Location of the fragment
+     * @return Fragment
+     */
+    static QByteArray fragment(const QByteArray& raw, const Span& span) { return raw.mid(span.start, span.length); }
+
+    /**
+     * Parses IRCv3 message tags
+     * @param decode Decoder to be used for decoding the tags
+     * @param raw Raw Message, as passed to tokenize()
+     * @param span Location of the tags, as determined by tokenize()
+     * @return Parsed message tags
+     */
+    static QHash<IrcTagKey, QString> decodeTags(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, const Span& span);
+
     /**
      * Extracts a space-delimited fragment from an IRC message
      * @param raw Raw Message
@@ -64,36 +118,4 @@ private:
      * @return decoded string
      */
     static QString parseTagValue(const QString& value);
-    /**
-     * Parses IRCv3 message tags given a message
-     * @param net Decoder to be used for decoding the message
-     * @param raw Raw Message
-     * @param start Current index into the message, will be advanced automatically
-     * @return Parsed message tags
-     */
-    static QHash<IrcTagKey, QString> parseTags(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start);
-    /**
-     * Parses an IRC prefix, if available
-     * @param net Decoder to be used for decoding the message
-     * @param raw Raw Message
-     * @param start Current index into the message, will be advanced automatically
-     * @return Parsed prefix or empty string
-     */
-    static QString parsePrefix(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start);
-    /**
-     * Parses an IRC named command or numeric RPL
-     * @param net Decoder to be used for decoding the message
-     * @param raw Raw Message
-     * @param start Current index into the message, will be advanced automatically
-     * @return Parsed command
-     */
-    static QString parseCommand(const std::function<QString(const QByteArray&)>& decode, const QByteArray& raw, int& start);
-    /**
-     * Parses an IRC parameter
-     * @param net Decoder to be used for decoding the message
-     * @param raw Raw Message
-     * @param start Current index into the message, will be advanced automatically
-     * @return Parsed parameter
-     */
-    static QByteArray parseParameter(const QByteArray& raw, int& start);
 };
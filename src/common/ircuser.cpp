@@ -183,7 +183,7 @@ void IrcUser::setLoginTime(const QDateTime& loginTime)
 void IrcUser::setServer(const QString& server)
 {
     if (!server.isEmpty() && _server != server) {
-        _server = server;
+        _server = network()->internString(server);
         SYNC(ARG(server))
     }
 }
@@ -191,7 +191,7 @@ void IrcUser::setServer(const QString& server)
 void IrcUser::setIrcOperator(const QString& ircOperator)
 {
     if (!ircOperator.isEmpty() && _ircOperator != ircOperator) {
-        _ircOperator = ircOperator;
+        _ircOperator = network()->internString(ircOperator);
         SYNC(ARG(ircOperator))
     }
 }
@@ -234,6 +234,9 @@ void IrcUser::setNick(const QString& nick)
         updateObjectName();
         SYNC(ARG(nick))
         emit nickSet(nick);
+        // Channels don't connect to each member's nickSet(), to save a connection per membership
+        foreach (IrcChannel* channel, _channels)
+            emit channel->ircUserNickSet(this, nick);
     }
 }
 
@@ -281,6 +284,7 @@ void IrcUser::joinChannel(IrcChannel* channel, bool skip_channel_join)
     Q_ASSERT(channel);
     if (!_channels.contains(channel)) {
         _channels.insert(channel);
+        network()->invalidateIrcUsersAndChannelsSnapshot();
         if (!skip_channel_join)
             channel->joinIrcUser(this);
     }
@@ -311,6 +315,7 @@ void IrcUser::partChannelInternal(IrcChannel* channel, bool skip_sync)
 {
     if (_channels.contains(channel)) {
         _channels.remove(channel);
+        network()->invalidateIrcUsersAndChannelsSnapshot();
         disconnect(channel, nullptr, this, nullptr);
         channel->part(this);
         QString channelName = channel->name();
@@ -344,15 +349,23 @@ void IrcUser::channelDestroyed()
     auto* channel = static_cast<IrcChannel*>(sender());
     if (_channels.contains(channel)) {
         _channels.remove(channel);
+        if (_network)
+            _network->invalidateIrcUsersAndChannelsSnapshot();
         if (_channels.isEmpty() && !network()->isMe(this))
             quit();
     }
 }
 
+void IrcUser::syncCalled() const
+{
+    if (_network)
+        _network->invalidateIrcUsersAndChannelsSnapshot();
+}
+
 void IrcUser::setUserModes(const QString& modes)
 {
     if (_userModes != modes) {
-        _userModes = modes;
+        _userModes = network()->internString(modes);
         SYNC(ARG(modes))
         emit userModesSet(modes);
     }
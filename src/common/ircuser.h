@@ -203,6 +203,9 @@ signals:
     void lastChannelActivityUpdated(BufferId id, const QDateTime& newTime);
     void lastSpokenToUpdated(BufferId id, const QDateTime& newTime);
 
+protected:
+    void syncCalled() const override;
+
 private slots:
     void updateObjectName();
     void channelDestroyed();
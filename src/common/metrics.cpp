@@ -0,0 +1,219 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "metrics.h"
+
+namespace Metrics {
+
+namespace {
+
+struct Instruments
+{
+    Histogram ircLineParse{"quassel_irc_line_parse_seconds", "Time spent parsing a line received from IRC"};
+    Histogram eventDispatch{"quassel_event_dispatch_seconds", "Time spent dispatching an event and the events it caused"};
+    Histogram storageCommit{"quassel_storage_commit_seconds", "Time spent committing messages to the storage backend"};
+    Histogram backlogQuery{"quassel_backlog_query_seconds", "Time spent querying backlog from the storage backend"};
+    Histogram signalProxySerialize{"quassel_signalproxy_serialize_seconds", "Time spent serializing a message for a peer"};
+    Histogram compression{"quassel_compressor_compress_seconds", "Time spent compressing a chunk of outgoing peer data"};
+    Histogram decompression{"quassel_compressor_decompress_seconds", "Time spent decompressing a chunk of incoming peer data"};
+    Histogram loginDuration{"quassel_login_duration_seconds", "Time taken to authenticate client logins"};
+
+    Counter signalProxyBytesSerialized{"quassel_signalproxy_serialized_bytes", "Amount of bytes serialized for peers"};
+    Counter compressorRawBytes{"quassel_compressor_raw_bytes", "Amount of uncompressed peer data passed through compression"};
+    Counter compressorWireBytes{"quassel_compressor_wire_bytes", "Amount of compressed peer data sent or received"};
+};
+
+Instruments& instruments()
+{
+    static Instruments instance;
+    return instance;
+}
+
+}  // namespace
+
+int currentShard()
+{
+    static std::atomic<int> nextShard{0};
+    thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+    return shard;
+}
+
+Counter::Counter(const char* name, const char* help)
+    : _name(name)
+    , _help(help)
+{
+    for (auto&& shard : _shards) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Counter::value() const
+{
+    uint64_t result = 0;
+    for (auto&& shard : _shards) {
+        result += shard.value.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+constexpr int Histogram::bucketCount;
+
+const std::array<int64_t, Histogram::bucketCount>& Histogram::bucketBounds()
+{
+    static const std::array<int64_t, bucketCount> bounds{{
+        1000,
+        5000,
+        10000,
+        50000,
+        100000,
+        500000,
+        1000000,
+        5000000,
+        10000000,
+        50000000,
+        100000000,
+        500000000,
+        1000000000,
+        5000000000,
+        10000000000,
+    }};
+    return bounds;
+}
+
+Histogram::Histogram(const char* name, const char* help)
+    : _name(name)
+    , _help(help)
+{
+    for (auto&& shard : _shards) {
+        for (auto&& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        shard.sumNsecs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(int64_t nsecs)
+{
+    const auto& bounds = bucketBounds();
+    int bucket = 0;
+    while (bucket < bucketCount && nsecs > bounds[bucket]) {
+        ++bucket;
+    }
+
+    Shard& shard = _shards[currentShard()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sumNsecs.fetch_add(nsecs, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    std::array<uint64_t, bucketCount + 1> buckets{};
+    Snapshot result{};
+    for (auto&& shard : _shards) {
+        for (int i = 0; i <= bucketCount; ++i) {
+            buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        result.sumNsecs += shard.sumNsecs.load(std::memory_order_relaxed);
+    }
+
+    uint64_t cumulative = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        cumulative += buckets[i];
+        result.buckets[i] = cumulative;
+    }
+    result.count = cumulative + buckets[bucketCount];
+    return result;
+}
+
+Histogram& ircLineParse()
+{
+    return instruments().ircLineParse;
+}
+
+Histogram& eventDispatch()
+{
+    return instruments().eventDispatch;
+}
+
+Histogram& storageCommit()
+{
+    return instruments().storageCommit;
+}
+
+Histogram& backlogQuery()
+{
+    return instruments().backlogQuery;
+}
+
+Histogram& signalProxySerialize()
+{
+    return instruments().signalProxySerialize;
+}
+
+Histogram& compression()
+{
+    return instruments().compression;
+}
+
+Histogram& decompression()
+{
+    return instruments().decompression;
+}
+
+Histogram& loginDuration()
+{
+    return instruments().loginDuration;
+}
+
+Counter& signalProxyBytesSerialized()
+{
+    return instruments().signalProxyBytesSerialized;
+}
+
+Counter& compressorRawBytes()
+{
+    return instruments().compressorRawBytes;
+}
+
+Counter& compressorWireBytes()
+{
+    return instruments().compressorWireBytes;
+}
+
+std::vector<const Counter*> counters()
+{
+    auto& i = instruments();
+    return {&i.signalProxyBytesSerialized, &i.compressorRawBytes, &i.compressorWireBytes};
+}
+
+std::vector<const Histogram*> histograms()
+{
+    auto& i = instruments();
+    return {&i.ircLineParse,
+            &i.eventDispatch,
+            &i.storageCommit,
+            &i.backlogQuery,
+            &i.signalProxySerialize,
+            &i.compression,
+            &i.decompression,
+            &i.loginDuration};
+}
+
+}  // namespace Metrics
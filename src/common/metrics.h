@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "common-export.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <QElapsedTimer>
+
+/**
+ * Instrumentation for hot paths, exported by the core's MetricsServer.
+ *
+ * Counters and histograms are sharded per thread: every thread updates its own cache line with relaxed atomics,
+ * so concurrent session threads never contend on an increment. Readers sum up all shards; the result may lag
+ * concurrent updates slightly, which is fine for monitoring.
+ *
+ * All instruments live for the whole lifetime of the process and are reached through the accessors below.
+ */
+namespace Metrics {
+
+//! Number of shards per instrument; threads are assigned to them round-robin
+constexpr int shardCount = 16;
+
+/**
+ * Returns the shard the calling thread updates.
+ */
+COMMON_EXPORT int currentShard();
+
+class COMMON_EXPORT Counter
+{
+public:
+    Counter(const char* name, const char* help);
+
+    void add(uint64_t value = 1) { _shards[currentShard()].value.fetch_add(value, std::memory_order_relaxed); }
+
+    uint64_t value() const;
+
+    const char* name() const { return _name; }
+    const char* help() const { return _help; }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value;
+    };
+
+    const char* _name;
+    const char* _help;
+    std::array<Shard, shardCount> _shards;
+};
+
+/**
+ * Latency histogram with a fixed set of buckets, spanning from a microsecond to ten seconds.
+ */
+class COMMON_EXPORT Histogram
+{
+public:
+    static constexpr int bucketCount = 15;
+
+    //! Upper bounds of the buckets, in nanoseconds
+    static const std::array<int64_t, bucketCount>& bucketBounds();
+
+    struct Snapshot
+    {
+        std::array<uint64_t, bucketCount> buckets;  ///< Cumulative, i.e. observations less or equal than each bound
+        uint64_t count;
+        int64_t sumNsecs;
+    };
+
+    Histogram(const char* name, const char* help);
+
+    void observe(int64_t nsecs);
+
+    Snapshot snapshot() const;
+
+    const char* name() const { return _name; }
+    const char* help() const { return _help; }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, bucketCount + 1> buckets;  ///< The last one counts observations above all bounds
+        std::atomic<int64_t> sumNsecs;
+    };
+
+    const char* _name;
+    const char* _help;
+    std::array<Shard, shardCount> _shards;
+};
+
+/**
+ * Observes the time from construction to destruction in the given histogram.
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : _histogram(histogram)
+    {
+        _timer.start();
+    }
+
+    ~ScopedTimer() { _histogram.observe(_timer.nsecsElapsed()); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& _histogram;
+    QElapsedTimer _timer;
+};
+
+COMMON_EXPORT Histogram& ircLineParse();
+COMMON_EXPORT Histogram& eventDispatch();
+COMMON_EXPORT Histogram& storageCommit();
+COMMON_EXPORT Histogram& backlogQuery();
+COMMON_EXPORT Histogram& signalProxySerialize();
+COMMON_EXPORT Histogram& compression();
+COMMON_EXPORT Histogram& decompression();
+COMMON_EXPORT Histogram& loginDuration();
+
+COMMON_EXPORT Counter& signalProxyBytesSerialized();
+COMMON_EXPORT Counter& compressorRawBytes();
+COMMON_EXPORT Counter& compressorWireBytes();
+
+//! All counters, for exporting
+COMMON_EXPORT std::vector<const Counter*> counters();
+
+//! All histograms, for exporting
+COMMON_EXPORT std::vector<const Histogram*> histograms();
+
+}  // namespace Metrics
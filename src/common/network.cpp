@@ -69,6 +69,8 @@ Network::Network(const NetworkId& networkid, QObject* parent)
 Network::~Network()
 {
     emit aboutToBeDestroyed();
+    // Our IrcUsers and IrcChannels are only deleted after this, make sure they don't find a snapshot to discard
+    invalidateIrcUsersAndChannelsSnapshot();
 }
 
 bool Network::isChannelName(const QString& channelname) const
@@ -358,6 +360,7 @@ void Network::removeIrcUser(IrcUser* ircuser)
         return;
 
     _ircUsers.remove(nick);
+    invalidateIrcUsersAndChannelsSnapshot();
     disconnect(ircuser, nullptr, this, nullptr);
     ircuser->deleteLater();
 }
@@ -369,6 +372,7 @@ void Network::removeIrcChannel(IrcChannel* channel)
         return;
 
     _ircChannels.remove(chanName);
+    invalidateIrcUsersAndChannelsSnapshot();
     disconnect(channel, nullptr, this, nullptr);
     channel->deleteLater();
 }
@@ -379,11 +383,26 @@ void Network::removeChansAndUsers()
     _ircUsers.clear();
     QList<IrcChannel*> channels = ircChannels();
     _ircChannels.clear();
+    _stringPool.clear();
+    invalidateIrcUsersAndChannelsSnapshot();
 
     qDeleteAll(users);
     qDeleteAll(channels);
 }
 
+QString Network::internString(const QString& string)
+{
+    if (string.isEmpty())
+        return string;
+
+    auto it = _stringPool.constFind(string);
+    if (it != _stringPool.constEnd())
+        return *it;
+
+    _stringPool.insert(string);
+    return string;
+}
+
 IrcChannel* Network::newIrcChannel(const QString& channelname, const QVariantMap& initData)
 {
     if (!_ircChannels.contains(channelname.toLower())) {
@@ -894,6 +913,10 @@ QVariantMap Network::initIrcUsersAndChannels() const
 {
     Q_ASSERT(proxy());
     Q_ASSERT(proxy()->targetPeer());
+    const bool longTime = proxy()->targetPeer()->hasFeature(Quassel::Feature::LongTime);
+    if (_ircUsersAndChannelsSnapshotValid[longTime])
+        return _ircUsersAndChannelsSnapshot[longTime];
+
     QVariantMap usersAndChannels;
 
     if (_ircUsers.count()) {
@@ -904,7 +927,7 @@ QVariantMap Network::initIrcUsersAndChannels() const
             QVariantMap map = it.value()->toVariantMap();
             // If the peer doesn't support LongTime, replace the lastAwayMessageTime field
             // with the 32-bit numerical seconds value (lastAwayMessage) used in older versions
-            if (!proxy()->targetPeer()->hasFeature(Quassel::Feature::LongTime)) {
+            if (!longTime) {
 #if QT_VERSION >= 0x050800
                 int lastAwayMessage = it.value()->lastAwayMessageTime().toSecsSinceEpoch();
 #else
@@ -950,9 +973,21 @@ QVariantMap Network::initIrcUsersAndChannels() const
         usersAndChannels["Channels"] = channelMap;
     }
 
+    _ircUsersAndChannelsSnapshot[longTime] = usersAndChannels;
+    _ircUsersAndChannelsSnapshotValid[longTime] = true;
     return usersAndChannels;
 }
 
+void Network::invalidateIrcUsersAndChannelsSnapshot() const
+{
+    for (int i = 0; i < 2; ++i) {
+        if (_ircUsersAndChannelsSnapshotValid[i]) {
+            _ircUsersAndChannelsSnapshot[i].clear();
+            _ircUsersAndChannelsSnapshotValid[i] = false;
+        }
+    }
+}
+
 void Network::initSetIrcUsersAndChannels(const QVariantMap& usersAndChannels)
 {
     Q_ASSERT(proxy());
@@ -1061,8 +1096,10 @@ void Network::ircUserNickChanged(QString newnick)
     if (oldnick.isNull())
         return;
 
-    if (newnick.toLower() != oldnick)
+    if (newnick.toLower() != oldnick) {
         _ircUsers[newnick.toLower()] = _ircUsers.take(oldnick);
+        invalidateIrcUsersAndChannelsSnapshot();
+    }
 
     if (myNick().toLower() == oldnick)
         setMyNick(newnick);
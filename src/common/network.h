@@ -30,6 +30,7 @@
 #include <QMutex>
 #include <QNetworkProxy>
 #include <QPointer>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QVariantMap>
@@ -566,8 +567,24 @@ public slots:
      */
     QVariantList initCapsEnabled() const { return toVariantList(capsEnabled()); }
     inline QVariantList initServerList() const { return toVariantList(serverList()); }
+    /**
+     * Get the init data for all known IrcUsers and IrcChannels.
+     *
+     * The result is cached until any of the users or channels changes, so that clients attaching in a row don't have to
+     * wait for the data to be collected again each time.
+     *
+     * @see invalidateIrcUsersAndChannelsSnapshot()
+     */
     virtual QVariantMap initIrcUsersAndChannels() const;
 
+    /**
+     * Discards the cached result of initIrcUsersAndChannels().
+     *
+     * Synced changes to the network, its IrcUsers and its IrcChannels call this automatically; other changes to the state
+     * of users and channels need to call it explicitly.
+     */
+    void invalidateIrcUsersAndChannelsSnapshot() const;
+
     // init seters
     void initSetSupports(const QVariantMap& supports);
     /**
@@ -720,7 +737,18 @@ protected:
     inline virtual IrcChannel* ircChannelFactory(const QString& channelname) { return new IrcChannel(channelname, this); }
     inline virtual IrcUser* ircUserFactory(const QString& hostmask) { return new IrcUser(hostmask, this); }
 
+    void syncCalled() const override { invalidateIrcUsersAndChannelsSnapshot(); }
+
 private:
+    /**
+     * Returns a copy of the given string sharing its data with any equal string interned before.
+     *
+     * Used by IrcUser and IrcChannel for values that repeat across many users (servers, operator status, modes), so that
+     * large channels don't keep thousands of identical copies around. The pool is only cleared on disconnect, so never use
+     * this for values that are (nearly) unique per user, such as idents or hostnames.
+     */
+    QString internString(const QString& string);
+
     QPointer<SignalProxy> _proxy;
 
     NetworkId _networkId;
@@ -738,6 +766,10 @@ private:
 
     QHash<QString, IrcUser*> _ircUsers;        // stores all known nicks for the server
     QHash<QString, IrcChannel*> _ircChannels;  // stores all known channels
+    // Cached results of initIrcUsersAndChannels(), indexed by whether the peer supports LongTime
+    mutable QVariantMap _ircUsersAndChannelsSnapshot[2];
+    mutable bool _ircUsersAndChannelsSnapshotValid[2]{false, false};
+    QSet<QString> _stringPool;  // see internString()
     QHash<QString, QString> _supports;         // stores results from RPL_ISUPPORT
 
     QHash<QString, QString> _caps;  /// Capabilities supported by the IRC server
@@ -73,6 +73,32 @@ Quassel::Features Peer::features() const
 void Peer::setFeatures(Quassel::Features features)
 {
     _features = std::move(features);
+    _featuresKey = _features.toStringList().join(',').toLatin1();
+}
+
+QByteArray Peer::featuresKey() const
+{
+    return _featuresKey;
+}
+
+QByteArray Peer::serializationKey() const
+{
+    return {};
+}
+
+QByteArray Peer::serialize(const Protocol::SyncMessage&)
+{
+    return {};
+}
+
+QByteArray Peer::serialize(const Protocol::RpcCall&)
+{
+    return {};
+}
+
+void Peer::writeSerialized(const QByteArray&)
+{
+    Q_ASSERT(false);
 }
 
 int Peer::id() const
@@ -68,9 +68,41 @@ public:
 
     virtual int lag() const = 0;
 
+    /**
+     * Returns the number of bytes queued for sending that have not been written to the network yet.
+     *
+     * Together with the bytesWritten() signal, this allows producers of large amounts of data to throttle
+     * themselves to what the connection can actually take.
+     */
+    virtual qint64 bytesToWrite() const = 0;
+
     virtual QString address() const = 0;
     virtual quint16 port() const = 0;
 
+    /**
+     * Returns a key describing how this peer encodes SignalProxy messages on the wire.
+     *
+     * Peers returning the same non-empty key produce identical bytes for a given message, so a message sent to
+     * several of them only needs to be serialized once (see serialize() and writeSerialized()). The default
+     * implementation returns an empty key, meaning that messages are always dispatched individually.
+     *
+     * @returns The serialization key, or an empty QByteArray if serialized messages can't be shared
+     */
+    virtual QByteArray serializationKey() const;
+
+    /**
+     * Serializes a message in the form expected by writeSerialized().
+     *
+     * Only called if serializationKey() is not empty.
+     */
+    virtual QByteArray serialize(const Protocol::SyncMessage& msg);
+    virtual QByteArray serialize(const Protocol::RpcCall& msg);
+
+    /**
+     * Sends a message previously produced by serialize() of a peer with the same serializationKey().
+     */
+    virtual void writeSerialized(const QByteArray& msg);
+
 public slots:
     /* Handshake messages */
     virtual void dispatch(const Protocol::RegisterClient&) = 0;
@@ -96,11 +128,17 @@ signals:
     void disconnected();
     void secureStateChanged(bool secure = true);
     void lagUpdated(int msecs);
+    void bytesWritten(qint64 bytes);
 
 protected:
     template<typename T>
     void handle(const T& protoMessage);
 
+    /**
+     * Returns a compact representation of the peer's feature set, for use in serializationKey().
+     */
+    QByteArray featuresKey() const;
+
 private:
     QPointer<AuthHandler> _authHandler;
 
@@ -109,6 +147,7 @@ private:
     QString _buildDate;
     QString _clientVersion;
     Quassel::Features _features;
+    QByteArray _featuresKey;
 
     int _id = -1;
 };
@@ -44,7 +44,9 @@ enum Type
 enum Feature
 {
     Encryption = 0x01,
-    Compression = 0x02
+    Compression = 0x02,
+    ZstdCompression = 0x04,  ///< Use zstd with the built-in dictionary instead of deflate; only valid in conjunction with Compression
+    Lz4Compression = 0x08    ///< Use LZ4 instead of deflate; only valid in conjunction with Compression
 };
 
 enum class Handler
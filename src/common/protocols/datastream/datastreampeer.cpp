@@ -21,19 +21,25 @@
 #include "datastreampeer.h"
 
 #include <QDataStream>
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QTcpSocket>
 #include <QtEndian>
 
+#include "metrics.h"
 #include "quassel.h"
 
 #include "serializers/serializers.h"
 
 using namespace Protocol;
 
-DataStreamPeer::DataStreamPeer(
-    ::AuthHandler* authHandler, QTcpSocket* socket, quint16 features, Compressor::CompressionLevel level, QObject* parent)
-    : RemotePeer(authHandler, socket, level, parent)
+DataStreamPeer::DataStreamPeer(::AuthHandler* authHandler,
+                               QTcpSocket* socket,
+                               quint16 features,
+                               Compressor::CompressionLevel level,
+                               Compressor::Algorithm algorithm,
+                               QObject* parent)
+    : RemotePeer(authHandler, socket, level, algorithm, parent)
 {
     Q_UNUSED(features);
 }
@@ -87,12 +93,20 @@ void DataStreamPeer::writeMessage(const QVariantMap& handshakeMsg)
 
 void DataStreamPeer::writeMessage(const QVariantList& sigProxyMsg)
 {
+    writeMessage(serializeMessage(sigProxyMsg));
+}
+
+QByteArray DataStreamPeer::serializeMessage(const QVariantList& sigProxyMsg)
+{
+    QElapsedTimer timer;
+    timer.start();
     QByteArray data;
     QDataStream msgStream(&data, QIODevice::WriteOnly);
     msgStream.setVersion(QDataStream::Qt_4_2);
     msgStream << sigProxyMsg;
-
-    writeMessage(data);
+    Metrics::signalProxySerialize().observe(timer.nsecsElapsed());
+    Metrics::signalProxyBytesSerialized().add(data.size());
+    return data;
 }
 
 /*** Handshake messages ***/
@@ -378,12 +392,22 @@ void DataStreamPeer::handlePackedFunc(const QVariantList& packedFunc)
 
 void DataStreamPeer::dispatch(const Protocol::SyncMessage& msg)
 {
-    dispatchPackedFunc(QVariantList() << (qint16)Sync << msg.className << msg.objectName.toUtf8() << msg.slotName << msg.params);
+    writeMessage(serialize(msg));
 }
 
 void DataStreamPeer::dispatch(const Protocol::RpcCall& msg)
 {
-    dispatchPackedFunc(QVariantList() << (qint16)RpcCall << msg.signalName << msg.params);
+    writeMessage(serialize(msg));
+}
+
+QByteArray DataStreamPeer::serialize(const Protocol::SyncMessage& msg)
+{
+    return serializeMessage(QVariantList() << (qint16)Sync << msg.className << msg.objectName.toUtf8() << msg.slotName << msg.params);
+}
+
+QByteArray DataStreamPeer::serialize(const Protocol::RpcCall& msg)
+{
+    return serializeMessage(QVariantList() << (qint16)RpcCall << msg.signalName << msg.params);
 }
 
 void DataStreamPeer::dispatch(const Protocol::InitRequest& msg)
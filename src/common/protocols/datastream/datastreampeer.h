@@ -40,7 +40,12 @@ public:
         HeartBeatReply
     };
 
-    DataStreamPeer(AuthHandler* authHandler, QTcpSocket* socket, quint16 features, Compressor::CompressionLevel level, QObject* parent = nullptr);
+    DataStreamPeer(AuthHandler* authHandler,
+                   QTcpSocket* socket,
+                   quint16 features,
+                   Compressor::CompressionLevel level,
+                   Compressor::Algorithm algorithm,
+                   QObject* parent = nullptr);
 
     Protocol::Type protocol() const override { return Protocol::DataStreamProtocol; }
     QString protocolName() const override { return "the DataStream protocol"; }
@@ -68,6 +73,9 @@ public:
     void dispatch(const Protocol::HeartBeat& msg) override;
     void dispatch(const Protocol::HeartBeatReply& msg) override;
 
+    QByteArray serialize(const Protocol::SyncMessage& msg) override;
+    QByteArray serialize(const Protocol::RpcCall& msg) override;
+
 signals:
     void protocolError(const QString& errorString);
 
@@ -75,6 +83,7 @@ private:
     using RemotePeer::writeMessage;
     void writeMessage(const QVariantMap& handshakeMsg);
     void writeMessage(const QVariantList& sigProxyMsg);
+    static QByteArray serializeMessage(const QVariantList& sigProxyMsg);
     void processMessage(const QByteArray& msg) override;
 
     void handleHandshakeMessage(const QVariantList& mapData);
@@ -21,9 +21,11 @@
 #include "legacypeer.h"
 
 #include <QDataStream>
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QTcpSocket>
 
+#include "metrics.h"
 #include "quassel.h"
 
 #include "serializers/serializers.h"
@@ -35,8 +37,9 @@ const uint clientNeedsProtocol = protocolVersion;
 
 using namespace Protocol;
 
-LegacyPeer::LegacyPeer(::AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent)
-    : RemotePeer(authHandler, socket, level, parent)
+LegacyPeer::LegacyPeer(
+    ::AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, Compressor::Algorithm algorithm, QObject* parent)
+    : RemotePeer(authHandler, socket, level, algorithm, parent)
     , _useCompression(false)
 {}
 
@@ -105,6 +108,13 @@ void LegacyPeer::processMessage(const QByteArray& msg)
 
 void LegacyPeer::writeMessage(const QVariant& item)
 {
+    writeMessage(serializeMessage(item));
+}
+
+QByteArray LegacyPeer::serializeMessage(const QVariant& item) const
+{
+    QElapsedTimer timer;
+    timer.start();
     QByteArray block;
     QDataStream out(&block, QIODevice::WriteOnly);
     out.setVersion(QDataStream::Qt_4_2);
@@ -123,7 +133,9 @@ void LegacyPeer::writeMessage(const QVariant& item)
         out << item;
     }
 
-    writeMessage(block);
+    Metrics::signalProxySerialize().observe(timer.nsecsElapsed());
+    Metrics::signalProxyBytesSerialized().add(block.size());
+    return block;
 }
 
 /*** Handshake messages ***/
@@ -452,12 +464,28 @@ void LegacyPeer::handlePackedFunc(const QVariant& packedFunc)
 
 void LegacyPeer::dispatch(const Protocol::SyncMessage& msg)
 {
-    dispatchPackedFunc(QVariantList() << (qint16)Sync << msg.className << msg.objectName << msg.slotName << msg.params);
+    writeMessage(serialize(msg));
 }
 
 void LegacyPeer::dispatch(const Protocol::RpcCall& msg)
 {
-    dispatchPackedFunc(QVariantList() << (qint16)RpcCall << msg.signalName << msg.params);
+    writeMessage(serialize(msg));
+}
+
+QByteArray LegacyPeer::serializationKey() const
+{
+    // The legacy protocol compresses each message individually
+    return RemotePeer::serializationKey() + (_useCompression ? "/z" : "");
+}
+
+QByteArray LegacyPeer::serialize(const Protocol::SyncMessage& msg)
+{
+    return serializeMessage(QVariant(QVariantList() << (qint16)Sync << msg.className << msg.objectName << msg.slotName << msg.params));
+}
+
+QByteArray LegacyPeer::serialize(const Protocol::RpcCall& msg)
+{
+    return serializeMessage(QVariant(QVariantList() << (qint16)RpcCall << msg.signalName << msg.params));
 }
 
 void LegacyPeer::dispatch(const Protocol::InitRequest& msg)
@@ -38,7 +38,11 @@ public:
         HeartBeatReply
     };
 
-    LegacyPeer(AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent = nullptr);
+    LegacyPeer(AuthHandler* authHandler,
+               QTcpSocket* socket,
+               Compressor::CompressionLevel level,
+               Compressor::Algorithm algorithm,
+               QObject* parent = nullptr);
 
     Protocol::Type protocol() const override { return Protocol::LegacyProtocol; }
     QString protocolName() const override { return "the legacy protocol"; }
@@ -64,12 +68,17 @@ public:
     void dispatch(const Protocol::HeartBeat& msg) override;
     void dispatch(const Protocol::HeartBeatReply& msg) override;
 
+    QByteArray serializationKey() const override;
+    QByteArray serialize(const Protocol::SyncMessage& msg) override;
+    QByteArray serialize(const Protocol::RpcCall& msg) override;
+
 signals:
     void protocolError(const QString& errorString);
 
 private:
     using RemotePeer::writeMessage;
     void writeMessage(const QVariant& item);
+    QByteArray serializeMessage(const QVariant& item) const;
     void processMessage(const QByteArray& msg) override;
 
     void handleHandshakeMessage(const QVariant& msg);
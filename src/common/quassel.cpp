@@ -364,6 +364,10 @@ void Quassel::setupCliParser()
             {"oidentd", tr("Enable oidentd integration. In most cases you should also enable --strict-ident.")},
             {"oidentd-conffile", tr("Set path to oidentd configuration file."), tr("file")},
             {"proxy-cidr", tr("Set IP range from which proxy protocol definitions are allowed"), tr("<address>[,...]"), "::1,127.0.0.1"},
+            {"compression",
+             tr("Compression algorithm to use with clients that support it: zstd, lz4 or deflate. Falls back to deflate otherwise."),
+             tr("algorithm"),
+             "zstd"},
             {"require-ssl", tr("Require SSL for remote (non-loopback) client connections.")},
             {"ssl-cert", tr("Specify the path to the SSL certificate."), tr("path"), "configdir/quasselCert.pem"},
             {"ssl-key", tr("Specify the path to the SSL key."), tr("path"), "ssl-cert-path"},
@@ -372,7 +376,19 @@ void Quassel::setupCliParser()
             {"tls-key", tr("Specify the path to the SSL key."), tr("path"), "ssl-cert-path"},
             {"metrics-daemon", tr("Enable metrics API.")},
             {"metrics-port", tr("The port quasselcore will listen at for metrics requests. Only meaningful with --metrics-daemon."), tr("port"), "9558"},
-            {"metrics-listen", tr("The address(es) quasselcore will listen on for metrics requests. Same format as --listen."), tr("<address>[,...]"), "::1,127.0.0.1"}
+            {"metrics-listen", tr("The address(es) quasselcore will listen on for metrics requests. Same format as --listen."), tr("<address>[,...]"), "::1,127.0.0.1"},
+            {"storage-commit-interval",
+             tr("Store messages of all users in group commits on a separate thread, delaying each message by at most this many milliseconds. "
+                "0 stores every message immediately."),
+             tr("ms"),
+             "0"},
+            {"storage-commit-size",
+             tr("Maximum number of messages per group commit. Only meaningful with --storage-commit-interval."),
+             tr("count"),
+             "1000"},
+            {"sqlite-wal",
+             tr("Run the SQLite database in write-ahead log mode, so that backlog requests don't have to wait for messages "
+                "being stored, and vice versa.")}
         };
     }
 
@@ -144,6 +144,8 @@ public:
         SyncedCoreInfo,       ///< CoreInfo dynamically updated using signals
         LoadBacklogForwards,  ///< Allow loading backlog in ascending order, old to new
         SkipIrcCaps,          ///< Control what IRCv3 capabilities are skipped during negotiation
+        BacklogBatchRequest,  ///< BacklogManager supports fetching backlog for many buffers in one request
+        BacklogStreaming,     ///< Backlog for all buffers may be sent as several consecutive pages
     };
     Q_ENUMS(Feature)
 
@@ -35,10 +35,11 @@ using namespace Protocol;
 const quint32 maxMessageSize = 64 * 1024
                                * 1024;  // This is uncompressed size. 64 MB should be enough for any sort of initData or backlog chunk
 
-RemotePeer::RemotePeer(::AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent)
+RemotePeer::RemotePeer(
+    ::AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, Compressor::Algorithm algorithm, QObject* parent)
     : Peer(authHandler, parent)
     , _socket(socket)
-    , _compressor(new Compressor(socket, level, this))
+    , _compressor(new Compressor(socket, level, algorithm, this))
     , _signalProxy(nullptr)
     , _proxyLine({})
     , _useProxyLine(false)
@@ -51,10 +52,12 @@ RemotePeer::RemotePeer(::AuthHandler* authHandler, QTcpSocket* socket, Compresso
     connect(socket, &QAbstractSocket::stateChanged, this, &RemotePeer::onSocketStateChanged);
     connect(socket, selectOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error), this, &RemotePeer::onSocketError);
     connect(socket, &QAbstractSocket::disconnected, this, &Peer::disconnected);
+    connect(socket, &QIODevice::bytesWritten, this, &Peer::bytesWritten);
 
     auto* sslSocket = qobject_cast<QSslSocket*>(socket);
     if (sslSocket) {
         connect(sslSocket, &QSslSocket::encrypted, this, [this]() { emit secureStateChanged(true); });
+        connect(sslSocket, &QSslSocket::encryptedBytesWritten, this, &Peer::bytesWritten);
     }
 
     connect(_compressor, &Compressor::readyRead, this, &RemotePeer::onReadyRead);
@@ -164,6 +167,26 @@ int RemotePeer::lag() const
     return _lag;
 }
 
+qint64 RemotePeer::bytesToWrite() const
+{
+    qint64 bytes = _socket->bytesToWrite();
+    auto* sslSocket = qobject_cast<QSslSocket*>(_socket);
+    if (sslSocket)
+        bytes += sslSocket->encryptedBytesToWrite();
+    return bytes;
+}
+
+QByteArray RemotePeer::serializationKey() const
+{
+    // Compression happens per connection after serialization, so it doesn't need to be part of the key
+    return QByteArray::number(protocol()) + '/' + QByteArray::number(enabledFeatures()) + '/' + featuresKey();
+}
+
+void RemotePeer::writeSerialized(const QByteArray& msg)
+{
+    writeMessage(msg);
+}
+
 QTcpSocket* RemotePeer::socket() const
 {
     return _socket;
@@ -206,7 +229,8 @@ void RemotePeer::close(const QString& reason)
 void RemotePeer::onReadyRead()
 {
     QByteArray msg;
-    while (readMessage(msg)) {
+    QByteArray buffer;  // keeps the data msg refers to alive
+    while (readMessage(msg, buffer)) {
         if (SignalProxy::current())
             SignalProxy::current()->setSourcePeer(this);
 
@@ -217,7 +241,7 @@ void RemotePeer::onReadyRead()
     }
 }
 
-bool RemotePeer::readMessage(QByteArray& msg)
+bool RemotePeer::readMessage(QByteArray& msg, QByteArray& buffer)
 {
     if (_msgSize == 0) {
         if (_compressor->bytesAvailable() < 4)
@@ -243,12 +267,10 @@ bool RemotePeer::readMessage(QByteArray& msg)
 
     emit transferProgress(_msgSize, _msgSize);
 
-    msg.resize(_msgSize);
-    qint64 bytesRead = _compressor->read(msg.data(), _msgSize);
-    if (bytesRead != _msgSize) {
-        close("Premature end of data stream!");
-        return false;
-    }
+    // Hand out the message as a view into the compressor's buffer rather than copying it. It is consumed right away,
+    // so that reentrant calls (e.g. through a nested event loop while processing it) continue with the next one.
+    msg = _compressor->peek(_msgSize, buffer);
+    _compressor->consume(_msgSize);
 
     _msgSize = 0;
     return true;
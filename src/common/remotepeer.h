@@ -43,7 +43,11 @@ public:
     using Peer::dispatch;
     using Peer::handle;
 
-    RemotePeer(AuthHandler* authHandler, QTcpSocket* socket, Compressor::CompressionLevel level, QObject* parent = nullptr);
+    RemotePeer(AuthHandler* authHandler,
+               QTcpSocket* socket,
+               Compressor::CompressionLevel level,
+               Compressor::Algorithm algorithm,
+               QObject* parent = nullptr);
 
     void setSignalProxy(SignalProxy* proxy) override;
 
@@ -63,6 +67,11 @@ public:
 
     int lag() const override;
 
+    qint64 bytesToWrite() const override;
+
+    QByteArray serializationKey() const override;
+    void writeSerialized(const QByteArray& msg) override;
+
     bool compressionEnabled() const;
     void setCompressionEnabled(bool enabled);
 
@@ -103,7 +112,7 @@ private slots:
     void changeHeartBeatInterval(int secs);
 
 private:
-    bool readMessage(QByteArray& msg);
+    bool readMessage(QByteArray& msg, QByteArray& buffer);
 
 private:
     QTcpSocket* _socket;
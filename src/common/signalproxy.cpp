@@ -342,12 +342,10 @@ void SignalProxy::dispatchSignal(QByteArray sigName, QVariantList params)
 {
     RpcCall rpcCall{std::move(sigName), std::move(params)};
     if (_restrictMessageTarget) {
-        for (auto&& peer : _restrictedTargets) {
-            dispatch(peer, rpcCall);
-        }
+        dispatchShared(_restrictedTargets.values(), rpcCall);
     }
     else {
-        dispatch(rpcCall);
+        dispatchShared(_peerMap.values(), rpcCall);
     }
 }
 
@@ -372,6 +370,36 @@ void SignalProxy::dispatch(Peer* peer, const T& protoMessage)
     _targetPeer = nullptr;
 }
 
+template<class T>
+void SignalProxy::dispatchShared(const QList<Peer*>& peers, const T& protoMessage)
+{
+    if (peers.count() == 1) {
+        dispatch(peers.first(), protoMessage);
+        return;
+    }
+
+    // Serialized messages, by serialization key; implicitly shared among all peers using the same key
+    QHash<QByteArray, QByteArray> serialized;
+    for (auto&& peer : peers) {
+        if (!peer || !peer->isOpen()) {
+            dispatch(peer, protoMessage);
+            continue;
+        }
+        QByteArray key = peer->serializationKey();
+        if (key.isEmpty()) {
+            dispatch(peer, protoMessage);
+            continue;
+        }
+
+        _targetPeer = peer;
+        auto it = serialized.find(key);
+        if (it == serialized.end())
+            it = serialized.insert(key, peer->serialize(protoMessage));
+        peer->writeSerialized(it.value());
+        _targetPeer = nullptr;
+    }
+}
+
 void SignalProxy::handle(Peer* peer, const SyncMessage& syncMessage)
 {
     if (!_syncSlave.contains(syncMessage.className) || !_syncSlave[syncMessage.className].contains(syncMessage.objectName)) {
@@ -597,14 +625,17 @@ void SignalProxy::sync_call__(const SyncableObject* obj, SignalProxy::ProxyMode
         params << QVariant(argTypes[i], va_arg(ap, void*));
     }
 
+    SyncMessage syncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params);
     if (_restrictMessageTarget) {
+        QList<Peer*> peers;
         for (auto peer : _restrictedTargets) {
             if (peer != nullptr)
-                dispatch(peer, SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
+                peers << peer;
         }
+        dispatchShared(peers, syncMessage);
     }
     else
-        dispatch(SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
+        dispatchShared(_peerMap.values(), syncMessage);
 }
 
 void SignalProxy::disconnectDevice(QIODevice* dev, const QString& reason)
@@ -260,6 +260,18 @@ private:
     template<class T>
     void dispatch(Peer* peer, const T& protoMessage);
 
+    /**
+     * Dispatches a SyncMessage or RpcCall to several peers.
+     *
+     * The message is serialized only once for each group of peers sharing the same Peer::serializationKey(),
+     * and the resulting buffer is then written to all peers of that group.
+     *
+     * @param peers        The target peers
+     * @param protoMessage The message
+     */
+    template<class T>
+    void dispatchShared(const QList<Peer*>& peers, const T& protoMessage);
+
     void handle(Peer* peer, const Protocol::SyncMessage& syncMessage);
     void handle(Peer* peer, const Protocol::RpcCall& rpcCall);
     void handle(Peer* peer, const Protocol::InitRequest& initRequest);
@@ -166,6 +166,7 @@ void SyncableObject::requestUpdate(const QVariantMap& properties)
 void SyncableObject::sync_call__(SignalProxy::ProxyMode modeType, const char* funcname, ...) const
 {
     // qDebug() << Q_FUNC_INFO << modeType << funcname;
+    syncCalled();
     foreach (SignalProxy* proxy, _signalProxies) {
         va_list ap;
         va_start(ap, funcname);
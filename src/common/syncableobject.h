@@ -93,6 +93,13 @@ public slots:
 protected:
     void sync_call__(SignalProxy::ProxyMode modeType, const char* funcname, ...) const;
 
+    /**
+     * Called on every sync call made by this object, i.e. whenever its state is changed by a synced setter.
+     *
+     * The default implementation does nothing. Override this to invalidate state derived from the object.
+     */
+    virtual void syncCalled() const {}
+
 signals:
     void initDone();
     void updatedRemotely();
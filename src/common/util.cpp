@@ -67,10 +67,73 @@ bool isChannelName(const QString& str)
     return std::any_of(prefixes.cbegin(), prefixes.cend(), [&str](quint8 c) { return c == str[0]; });
 }
 
+namespace {
+
+bool isFormatCode(ushort c)
+{
+    switch (c) {
+    case '\x02':
+    case '\x03':
+    case '\x04':
+    case '\x0f':
+    case '\x11':
+    case '\x12':
+    case '\x16':
+    case '\x1d':
+    case '\x1e':
+    case '\x1f':
+        return true;
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
 QString stripFormatCodes(QString message)
 {
-    static QRegExp regEx{"\x03(\\d\\d?(,\\d\\d?)?)?|\x04([\\da-fA-F]{6}(,[\\da-fA-F]{6})?)?|[\x02\x0f\x11\x12\x16\x1d\x1e\x1f]"};
-    return message.remove(regEx);
+    const QChar* data = message.constData();
+    const int size = message.size();
+
+    // Most messages don't contain any format codes, avoid copying those
+    int pos = 0;
+    while (pos < size && !isFormatCode(data[pos].unicode()))
+        ++pos;
+    if (pos == size)
+        return message;
+
+    auto isDigit = [&](int i) { return i < size && data[i].isDigit(); };
+    auto isHexColor = [&](int i) {
+        for (int end = i + 6; i < end; ++i) {
+            if (i >= size || !(data[i].isDigit() || (data[i] >= 'a' && data[i] <= 'f') || (data[i] >= 'A' && data[i] <= 'F')))
+                return false;
+        }
+        return true;
+    };
+
+    // Same as removing \x03(\d\d?(,\d\d?)?)?|\x04([\da-fA-F]{6}(,[\da-fA-F]{6})?)?|[\x02\x0f\x11\x12\x16\x1d\x1e\x1f]
+    QString result;
+    result.reserve(size);
+    result.append(data, pos);
+    while (pos < size) {
+        ushort c = data[pos].unicode();
+        if (!isFormatCode(c)) {
+            result.append(data[pos++]);
+            continue;
+        }
+        ++pos;
+        if (c == '\x03' && isDigit(pos)) {
+            pos += isDigit(pos + 1) ? 2 : 1;
+            if (pos < size && data[pos] == ',' && isDigit(pos + 1))
+                pos += isDigit(pos + 2) ? 3 : 2;
+        }
+        else if (c == '\x04' && isHexColor(pos)) {
+            pos += 6;
+            if (pos < size && data[pos] == ',' && isHexColor(pos + 1))
+                pos += 7;
+        }
+    }
+    return result;
 }
 
 QString stripAcceleratorMarkers(const QString& label_)
@@ -362,3 +425,67 @@ QString formatDateTimeToOffsetISO(const QDateTime& dateTime)
     // Remove the "T" date/time separator
     return dateTime.toOffsetFromUtc(dateTime.offsetFromUtc()).toString(Qt::ISODate).replace(10, 1, " ");
 }
+
+QDateTime parseISODateTime(const QString& dateTime)
+{
+    const QChar* str = dateTime.constData();
+    const int size = dateTime.size();
+    int pos = 0;
+
+    auto isDigit = [&](int i) { return i < size && str[i] >= QLatin1Char('0') && str[i] <= QLatin1Char('9'); };
+    auto readNumber = [&](int digits, int& value) {
+        value = 0;
+        for (int end = pos + digits; pos < end; ++pos) {
+            if (!isDigit(pos))
+                return false;
+            value = value * 10 + (str[pos].unicode() - '0');
+        }
+        return true;
+    };
+    auto skip = [&](char c) {
+        if (pos < size && str[pos] == QLatin1Char(c)) {
+            ++pos;
+            return true;
+        }
+        return false;
+    };
+
+    int year, month, day, hour, minute, second;
+    if (!readNumber(4, year) || !skip('-') || !readNumber(2, month) || !skip('-') || !readNumber(2, day) || !(skip('T') || skip(' '))
+        || !readNumber(2, hour) || !skip(':') || !readNumber(2, minute) || !skip(':') || !readNumber(2, second)) {
+        return {};
+    }
+
+    int msec = 0;
+    if (skip('.')) {
+        int digits = 0;
+        for (; isDigit(pos); ++pos, ++digits) {
+            if (digits < 3)
+                msec = msec * 10 + (str[pos].unicode() - '0');
+        }
+        if (digits == 0)
+            return {};
+        for (; digits < 3; ++digits)
+            msec *= 10;
+    }
+
+    int offset = 0;
+    if (!skip('Z')) {
+        int sign = skip('+') ? 1 : skip('-') ? -1 : 0;
+        int offsetHours, offsetMinutes;
+        if (!sign || !readNumber(2, offsetHours))
+            return {};
+        skip(':');
+        if (!readNumber(2, offsetMinutes))
+            return {};
+        offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    }
+    if (pos != size)
+        return {};
+
+    QDate date{year, month, day};
+    QTime time{hour, minute, second, msec};
+    if (!date.isValid() || !time.isValid())
+        return {};
+    return QDateTime{date, time, Qt::UTC}.addSecs(-offset);
+}
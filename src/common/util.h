@@ -22,6 +22,7 @@
 
 #include "common-export.h"
 
+#include <QDateTime>
 #include <QList>
 #include <QSet>
 #include <QString>
@@ -114,6 +115,17 @@ COMMON_EXPORT QString tryFormatUnixEpoch(const QString& possibleEpochDate,
  */
 COMMON_EXPORT QString formatDateTimeToOffsetISO(const QDateTime& dateTime);
 
+/**
+ * Parse an ISO 8601 date/time as used by IRCv3 server-time, e.g. "2011-10-19T16:40:51.620Z"
+ *
+ * Fractional seconds are optional and truncated to milliseconds.  Besides "Z", numeric UTC offsets
+ * ("+02:00", "-0500") are accepted.
+ *
+ * @param dateTime Date/time string to parse
+ * @return The date/time in UTC, or an invalid QDateTime if the string can't be parsed
+ */
+COMMON_EXPORT QDateTime parseISODateTime(const QString& dateTime);
+
 namespace detail {
 
 template<typename... Args>
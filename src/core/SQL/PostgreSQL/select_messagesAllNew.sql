@@ -1,6 +1,8 @@
-SELECT messageid, bufferid, time,  type, flags, sender, senderprefixes, realname, avatarurl, message
+SELECT messageid, backlog.bufferid, time,  type, flags, sender, senderprefixes, realname, avatarurl, message, buffer.networkid, buffertype, groupid, buffername
 FROM backlog
 JOIN sender ON backlog.senderid = sender.senderid
-WHERE backlog.bufferid IN (SELECT bufferid FROM buffer WHERE userid = :userid)
+JOIN buffer ON backlog.bufferid = buffer.bufferid
+WHERE buffer.userid = :userid
     AND backlog.messageid >= :firstmsg
 ORDER BY messageid DESC
+LIMIT :limit
@@ -1,10 +1,11 @@
-SELECT messageid, bufferid, time, type, flags, sender, senderprefixes, realname, avatarurl, message
+SELECT messageid, backlog.bufferid, time, type, flags, sender, senderprefixes, realname, avatarurl, message, buffer.networkid, buffertype, groupid, buffername
 FROM backlog
 JOIN sender ON backlog.senderid = sender.senderid
-WHERE backlog.bufferid IN (SELECT bufferid FROM buffer WHERE userid = :userid)
+JOIN buffer ON backlog.bufferid = buffer.bufferid
+WHERE buffer.userid = :userid
     AND backlog.messageid >= :firstmsg
     AND backlog.messageid < :lastmsg
     AND (:type <= 0 OR backlog.type & :type != 0)
     AND (:flags <= 0 OR backlog.flags & :flags != 0)
 ORDER BY messageid DESC
--- Unlike SQLite, no LIMIT clause, mimicking the unfiltered version - investigate later..?
+LIMIT :limit
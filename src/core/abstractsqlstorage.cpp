@@ -41,6 +41,7 @@ AbstractSqlStorage::~AbstractSqlStorage()
     // disconnect the connections, so their deletion is no longer interesting for us
     QHash<QThread*, Connection*>::iterator conIter;
     for (conIter = _connectionPool.begin(); conIter != _connectionPool.end(); ++conIter) {
+        conIter.value()->statementCache() = {};
         QSqlDatabase::removeDatabase(conIter.value()->name());
         disconnect(conIter.value(), nullptr, this, nullptr);
     }
@@ -56,6 +57,8 @@ QSqlDatabase AbstractSqlStorage::logDb()
     if (!db.isOpen()) {
         qWarning() << "Database connection" << displayName() << "for thread" << QThread::currentThread()
                    << "was lost, attempting to reconnect...";
+        // Prepared statements are bound to the lost connection
+        _connectionPool[QThread::currentThread()]->statementCache() = {};
         dbConnect(db);
     }
 
@@ -155,6 +158,14 @@ Storage::State AbstractSqlStorage::init(const QVariantMap& settings, const QProc
 
 QString AbstractSqlStorage::queryString(const QString& queryName, int version)
 {
+    const QPair<int, QString> cacheKey{version, queryName};
+    {
+        QMutexLocker locker(&_queryStringMutex);
+        auto it = _queryStrings.constFind(cacheKey);
+        if (it != _queryStrings.constEnd())
+            return *it;
+    }
+
     QFileInfo queryInfo;
 
     // The current schema is stored in the root folder, while upgrade queries are stored in the
@@ -177,10 +188,41 @@ QString AbstractSqlStorage::queryString(const QString& queryName, int version)
     QFile queryFile(queryInfo.filePath());
     if (!queryFile.open(QIODevice::ReadOnly | QIODevice::Text))
         return QString();
-    QString query = QTextStream(&queryFile).readAll();
+    QString query = QTextStream(&queryFile).readAll().trimmed();
     queryFile.close();
 
-    return query.trimmed();
+    // The SQL resources are compiled in, so their contents never change
+    QMutexLocker locker(&_queryStringMutex);
+    _queryStrings.insert(cacheKey, query);
+    return query;
+}
+
+AbstractSqlStorage::StatementCache* AbstractSqlStorage::statementCache(const QSqlDatabase& db)
+{
+    QMutexLocker locker(&_connectionPoolMutex);
+    Connection* connection = _connectionPool.value(QThread::currentThread());
+    // Connections not taken from the pool (e.g. the ones used for migration) aren't cached
+    if (!connection || db.connectionName() != connection->name())
+        return nullptr;
+    return &connection->statementCache();
+}
+
+QSqlQuery AbstractSqlStorage::cachedQuery(const QString& queryName, const QSqlDatabase& db)
+{
+    StatementCache* cache = statementCache(db);
+    if (cache) {
+        auto it = cache->queries.find(queryName);
+        if (it != cache->queries.end()) {
+            // Release any result set still held from the previous use
+            it->finish();
+            return *it;
+        }
+    }
+
+    QSqlQuery query(db);
+    if (query.prepare(queryString(queryName)) && cache)
+        cache->queries.insert(queryName, query);
+    return query;
 }
 
 std::vector<AbstractSqlStorage::SqlQueryResource> AbstractSqlStorage::setupQueries()
@@ -413,6 +455,8 @@ AbstractSqlStorage::Connection::Connection(const QString& name, QObject* parent)
 
 AbstractSqlStorage::Connection::~Connection()
 {
+    // Cached queries must be gone before the connection can be removed
+    _statementCache = {};
     {
         QSqlDatabase db = QSqlDatabase::database(name(), false);
         if (db.isOpen()) {
@@ -25,6 +25,8 @@
 
 #include <QHash>
 #include <QMutex>
+#include <QPair>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
@@ -91,6 +93,40 @@ protected:
      */
     QString queryString(const QString& queryName, int version = 0);
 
+    /**
+     * Per-connection cache of prepared statements
+     *
+     * Each thread's connection owns one of these. It is dropped whenever the connection has to be
+     * reestablished, as prepared statements don't survive a reconnect.
+     */
+    struct StatementCache
+    {
+        QHash<QString, QSqlQuery> queries;  ///< Client-side prepared queries, see cachedQuery()
+        QSet<QString> serverPrepared;       ///< Names of statements the backend has PREPAREd server-side
+    };
+
+    /**
+     * Gets the statement cache for the given connection
+     *
+     * @param db  The database connection, as returned by logDb()
+     * @return The statement cache, or nullptr if db is not the current thread's pooled connection
+     */
+    StatementCache* statementCache(const QSqlDatabase& db);
+
+    /**
+     * Fetch a prepared SQL query by name, reusing it for the lifetime of the connection
+     *
+     * The query is prepared from queryString() on first use in the current thread and kept in the
+     * connection's statement cache afterwards. The returned query shares its state with the cached
+     * one, so all placeholders must be bound again before executing it. Queries that are only read
+     * partially (e.g. via first()) should be finish()ed after use.
+     *
+     * @param[in] queryName  File name of the SQL query, minus the .sql extension
+     * @param[in] db         The database connection, as returned by logDb()
+     * @return Prepared query, ready for binding values
+     */
+    QSqlQuery cachedQuery(const QString& queryName, const QSqlDatabase& db);
+
     /**
      * Gets the collection of SQL setup queries and filenames to create a new database
      *
@@ -167,6 +203,10 @@ private:
 
     static int _nextConnectionId;
     QMutex _connectionPoolMutex;
+
+    QMutex _queryStringMutex;
+    QHash<QPair<int, QString>, QString> _queryStrings;  ///< SQL resource contents, keyed by schema version and query name
+
     // we let a Connection Object manage each actual db connection
     // those objects reside in the thread the connection belongs to
     // which allows us thread safe termination of a connection
@@ -197,8 +237,11 @@ public:
 
     inline QLatin1String name() const { return QLatin1String(_name); }
 
+    inline StatementCache& statementCache() { return _statementCache; }
+
 private:
     QByteArray _name;
+    StatementCache _statementCache;
 };
 
 // ========================================
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "bufferinfocache.h"
+
+#include <utility>
+
+BufferInfoCache::BufferInfoCache(Resolver resolver)
+    : _resolver(std::move(resolver))
+{}
+
+BufferInfo BufferInfoCache::lookup(NetworkId networkId, BufferInfo::Type type, const QString& bufferName, bool create)
+{
+    // Buffer names are matched case-insensitively by the storage backends, too
+    QHash<QString, BufferInfo>& networkCache = _buffers[networkId];
+    const QString key = bufferName.toLower();
+    auto cachedInfo = networkCache.constFind(key);
+    if (cachedInfo != networkCache.constEnd()) {
+        // Like the storage backends, return the buffer under the name it was requested with
+        return BufferInfo(cachedInfo->bufferId(), networkId, cachedInfo->type(), cachedInfo->groupId(), bufferName);
+    }
+
+    BufferInfo bufferInfo = _resolver(networkId, type, bufferName, create);
+    if (bufferInfo.isValid() && !_pendingRemovals.contains(bufferInfo.bufferId()))
+        networkCache.insert(key, bufferInfo);
+    return bufferInfo;
+}
+
+BufferInfo BufferInfoCache::cached(NetworkId networkId, const QString& bufferName) const
+{
+    return _buffers.value(networkId).value(bufferName.toLower());
+}
+
+void BufferInfoCache::beginRemoval(BufferId bufferId)
+{
+    _pendingRemovals.insert(bufferId);
+    evict(bufferId);
+}
+
+void BufferInfoCache::endRemoval(BufferId bufferId)
+{
+    _pendingRemovals.remove(bufferId);
+    evict(bufferId);
+}
+
+void BufferInfoCache::evict(BufferId bufferId)
+{
+    for (auto& networkCache : _buffers) {
+        for (auto it = networkCache.begin(); it != networkCache.end();) {
+            if (it->bufferId() == bufferId)
+                it = networkCache.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+void BufferInfoCache::evictNetwork(NetworkId networkId)
+{
+    _buffers.remove(networkId);
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include "core-export.h"
+
+#include <functional>
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "bufferinfo.h"
+
+/**
+ * Caches the BufferInfo of a session's buffers by network and case-folded name.
+ *
+ * Buffers can be in the process of being removed, i.e. removal was requested but the storage backend has not deleted them yet.
+ * Such buffers are evicted when their removal starts and are not cached again until it has finished, so that messages arriving
+ * in the meantime never stay associated with a buffer that is about to vanish.
+ */
+class CORE_EXPORT BufferInfoCache
+{
+public:
+    /// Looks up a buffer in the storage backend, returning an invalid BufferInfo if there is none
+    using Resolver = std::function<BufferInfo(NetworkId networkId, BufferInfo::Type type, const QString& bufferName, bool create)>;
+
+    explicit BufferInfoCache(Resolver resolver);
+
+    /**
+     * Looks up the BufferInfo for a buffer, optionally creating the buffer.
+     *
+     * Only the first lookup of a buffer is passed to the resolver.
+     * @param networkId The network the buffer belongs to
+     * @param type The type of the buffer, if it needs to be created
+     * @param bufferName The name of the buffer
+     * @param create Whether to create the buffer if it does not exist yet
+     * @returns The BufferInfo, which is invalid if the buffer neither existed nor was created
+     */
+    BufferInfo lookup(NetworkId networkId, BufferInfo::Type type, const QString& bufferName, bool create = true);
+
+    /**
+     * Returns the cached BufferInfo for a buffer without querying the resolver.
+     * @returns The BufferInfo, which is invalid if the buffer is not cached
+     */
+    BufferInfo cached(NetworkId networkId, const QString& bufferName) const;
+
+    /**
+     * Evicts a buffer whose removal has been requested, and keeps it out of the cache until endRemoval() is called.
+     * @param bufferId The buffer that is being removed
+     */
+    void beginRemoval(BufferId bufferId);
+
+    /**
+     * Marks the removal of a buffer as finished, evicting it in case it was looked up in the meantime.
+     * @param bufferId The buffer that has been removed
+     */
+    void endRemoval(BufferId bufferId);
+
+    /**
+     * Removes a buffer from the cache, e.g. because it has been renamed or merged into another one.
+     * @param bufferId The buffer to remove
+     */
+    void evict(BufferId bufferId);
+
+    /**
+     * Removes all buffers of a network from the cache.
+     * @param networkId The network that has been removed
+     */
+    void evictNetwork(NetworkId networkId);
+
+private:
+    Resolver _resolver;
+    QHash<NetworkId, QHash<QString, BufferInfo>> _buffers;  ///< Buffers by case-folded name
+    QSet<BufferId> _pendingRemovals;
+};
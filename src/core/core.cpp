@@ -21,8 +21,11 @@
 #include "core.h"
 
 #include <algorithm>
+#include <random>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QMutexLocker>
 
 #include "coreauthhandler.h"
 #include "coresession.h"
@@ -54,6 +57,13 @@
 // ==============================
 const int Core::AddClientEventId = QEvent::registerEventType();
 
+namespace {
+
+// How long a verified login is trusted without asking the storage or auth provider again
+const qint64 loginCacheTimeout = 2 * 60 * 1000;
+
+}  // namespace
+
 class AddClientEvent : public QEvent
 {
 public:
@@ -80,12 +90,30 @@ Core::Core()
     _server.setParent(this);
     _v6server.setParent(this);
     _storageSyncTimer.setParent(this);
+
+    // Password hashing and LDAP binds are slow, so they run on a few worker threads rather than
+    // the main thread. Workers keep their database connection, so don't let them expire.
+    _authThreadPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), 4));
+    _authThreadPool.setExpiryTimeout(-1);
+
+    // Cached logins only ever hold a salted hash of the password
+    std::random_device seed;
+    std::mt19937 generator(seed());
+    std::uniform_int_distribution<int> distribution(0, 255);
+    _loginCacheSalt.resize(32);
+    for (int i = 0; i < _loginCacheSalt.size(); i++) {
+        _loginCacheSalt[i] = (char)distribution(generator);
+    }
 }
 
 Core::~Core()
 {
+    // Let pending logins finish before their handlers and the storage go away
+    _authThreadPool.waitForDone();
     qDeleteAll(_connectingClients);
     qDeleteAll(_sessions);
+    // Commit whatever is still queued before the storage goes away
+    delete _messageWriter;
     syncStorage();
 }
 
@@ -100,6 +128,12 @@ void Core::init()
         throw ExitException{EXIT_FAILURE, tr("Invalid core settings version!")};
     }
 
+    // Client connections would silently fall back to zstd otherwise
+    const QString compression = Quassel::optionValue("compression");
+    if (compression != "zstd" && compression != "lz4" && compression != "deflate") {
+        throw ExitException{EXIT_FAILURE, tr("Invalid compression algorithm \"%1\", expected zstd, lz4 or deflate.").arg(compression)};
+    }
+
     // Set up storage and authentication backends
     registerStorageBackends();
     registerAuthenticators();
@@ -219,6 +253,15 @@ void Core::init()
             _v6server.setMetricsServer(_metricsServer);
         }
 
+        int commitInterval = Quassel::optionValue("storage-commit-interval").toInt();
+        if (commitInterval > 0) {
+            _messageWriter = new MessageWriter(_storage.get(),
+                                               _metricsServer,
+                                               commitInterval,
+                                               Quassel::optionValue("storage-commit-size").toInt());
+            _messageWriter->start();
+        }
+
         Quassel::registerReloadHandler([]() {
             // Currently, only reloading SSL certificates and the sysident cache is supported
             if (Core::instance()) {
@@ -1109,7 +1152,71 @@ bool Core::changeUserPassword(UserId userId, const QString& password)
     if (!canChangeUserPassword(userId))
         return false;
 
-    return instance()->_storage->updateUser(userId, password);
+    if (!instance()->_storage->updateUser(userId, password))
+        return false;
+
+    instance()->forgetCachedLogins(userId);
+    return true;
+}
+
+UserId Core::authenticateLogin(const QString& userName, const QString& password)
+{
+    Core* core = instance();
+    const QByteArray passwordHash = QCryptographicHash::hash(core->_loginCacheSalt + password.toUtf8(), QCryptographicHash::Sha512);
+    quint64 generation;
+    {
+        QMutexLocker locker(&core->_loginCacheMutex);
+        auto it = core->_loginCache.constFind(userName);
+        if (it != core->_loginCache.constEnd() && it->expires > QDateTime::currentMSecsSinceEpoch() && it->passwordHash == passwordHash) {
+            return it->userId;
+        }
+        generation = core->_loginCacheGeneration;
+    }
+
+    // First attempt local auth using the real username and password.
+    // If that fails, move onto the auth provider.
+
+    // Check to see if the user has the "Database" authenticator configured.
+    UserId uid = 0;
+    if (getUserAuthenticator(userName) == "Database") {
+        uid = validateUser(userName, password);
+    }
+
+    // If they did not, *or* if the database login fails, try to use a different authenticator.
+    // TODO: this logic should likely be moved into Core::authenticateUser in the future.
+    // Right now a core can only have one authenticator configured; this might be something
+    // to change in the future.
+    if (uid == 0) {
+        uid = authenticateUser(userName, password);
+    }
+
+    if (uid.isValid()) {
+        QMutexLocker locker(&core->_loginCacheMutex);
+        // Don't resurrect a login whose password changed while we were checking it
+        if (generation == core->_loginCacheGeneration) {
+            const qint64 now = QDateTime::currentMSecsSinceEpoch();
+            for (auto it = core->_loginCache.begin(); it != core->_loginCache.end();) {
+                if (it->expires <= now)
+                    it = core->_loginCache.erase(it);
+                else
+                    ++it;
+            }
+            core->_loginCache.insert(userName, {passwordHash, uid, now + loginCacheTimeout});
+        }
+    }
+    return uid;
+}
+
+void Core::forgetCachedLogins(UserId userId)
+{
+    QMutexLocker locker(&_loginCacheMutex);
+    for (auto it = _loginCache.begin(); it != _loginCache.end();) {
+        if (it->userId == userId)
+            it = _loginCache.erase(it);
+        else
+            ++it;
+    }
+    ++_loginCacheGeneration;
 }
 
 // TODO: this code isn't currently 100% optimal because the core
@@ -26,9 +26,12 @@
 #include <vector>
 
 #include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QPointer>
 #include <QSslSocket>
 #include <QString>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVariant>
 
@@ -37,6 +40,8 @@
 #include "deferredptr.h"
 #include "identserver.h"
 #include "message.h"
+#include "messagewriter.h"
+#include "metrics.h"
 #include "metricsserver.h"
 #include "oidentdconfiggenerator.h"
 #include "sessionthread.h"
@@ -96,6 +101,21 @@ public:
         return instance()->_authenticator->validateUser(userName, password);
     }
 
+    //! Authenticate a client login
+    /**
+     * Tries the database first if the user is configured for it, then falls back to the active
+     * auth provider. Successful logins are remembered for a short while, so a burst of clients
+     * reconnecting at once doesn't redo every password hash and LDAP bind.
+     * Safe to call from the auth worker threads.
+     * \param userName The user's login name
+     * \param password The user's uncrypted password
+     * \return The user's ID if valid; 0 otherwise
+     */
+    static UserId authenticateLogin(const QString& userName, const QString& password);
+
+    //! Thread pool running login authentication off the main thread
+    static inline QThreadPool* authThreadPool() { return &instance()->_authThreadPool; }
+
     //! Add a new user, exposed so auth providers can call this without being the storage.
     /**
      * \param userName The user's login name
@@ -383,7 +403,11 @@ public:
      *  \param message The message object to be stored
      *  \return true on success
      */
-    static inline bool storeMessage(Message& message) { return instance()->_storage->logMessage(message); }
+    static inline bool storeMessage(Message& message)
+    {
+        Metrics::ScopedTimer timer(Metrics::storageCommit());
+        return instance()->_storage->logMessage(message);
+    }
 
     //! Store a list of Messages in the storage backend and set their unique Id.
     /** \note This method is threadsafe.
@@ -391,7 +415,11 @@ public:
      *  \param messages The list message objects to be stored
      *  \return true on success
      */
-    static inline bool storeMessages(MessageList& messages) { return instance()->_storage->logMessages(messages); }
+    static inline bool storeMessages(MessageList& messages)
+    {
+        Metrics::ScopedTimer timer(Metrics::storageCommit());
+        return instance()->_storage->logMessages(messages);
+    }
 
     //! Request a certain number messages stored in a given buffer.
     /** \param buffer   The buffer we request messages from
@@ -402,9 +430,20 @@ public:
      */
     static inline std::vector<Message> requestMsgs(UserId user, BufferId bufferId, MsgId first = -1, MsgId last = -1, int limit = -1)
     {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
         return instance()->_storage->requestMsgs(user, bufferId, first, last, limit);
     }
 
+    //! Request messages for several buffers at once.
+    /** \param requests The per-buffer requests, with the same semantics as for requestMsgs()
+     *  \return One list of messages per request, in request order
+     */
+    static inline std::vector<std::vector<Message>> requestMsgsBatch(UserId user, const std::vector<Storage::MsgRequest>& requests)
+    {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
+        return instance()->_storage->requestMsgsBatch(user, requests);
+    }
+
     //! Request a certain number messages stored in a given buffer, matching certain filters
     /** \param buffer   The buffer we request messages from
      *  \param first    if != -1 return only messages with a MsgId >= first
@@ -421,6 +460,7 @@ public:
                                                      Message::Types type = Message::Types{-1},
                                                      Message::Flags flags = Message::Flags{-1})
     {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
         return instance()->_storage->requestMsgsFiltered(user, bufferId, first, last, limit, type, flags);
     }
 
@@ -441,6 +481,7 @@ public:
                                                            Message::Types type = Message::Types{-1},
                                                            Message::Flags flags = Message::Flags{-1})
     {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
         return instance()->_storage->requestMsgsForward(user, bufferId, first, last, limit, type, flags);
     }
 
@@ -452,6 +493,7 @@ public:
      */
     static inline std::vector<Message> requestAllMsgs(UserId user, MsgId first = -1, MsgId last = -1, int limit = -1)
     {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
         return instance()->_storage->requestAllMsgs(user, first, last, limit);
     }
 
@@ -469,6 +511,7 @@ public:
                                                         Message::Types type = Message::Types{-1},
                                                         Message::Flags flags = Message::Flags{-1})
     {
+        Metrics::ScopedTimer timer(Metrics::backlogQuery());
         return instance()->_storage->requestAllMsgsFiltered(user, first, last, limit, type, flags);
     }
 
@@ -679,6 +722,13 @@ public:
     inline IdentServer* identServer() const { return _identServer; }
     inline MetricsServer* metricsServer() const { return _metricsServer; }
 
+    /**
+     * Returns the write-behind stage for message storage, if enabled.
+     *
+     * @return The message writer, or nullptr if messages are stored synchronously
+     */
+    inline MessageWriter* messageWriter() const { return _messageWriter; }
+
     static const int AddClientEventId;
 
 signals:
@@ -805,6 +855,22 @@ private:
 
     IdentServer* _identServer{nullptr};
     MetricsServer* _metricsServer{nullptr};
+    MessageWriter* _messageWriter{nullptr};
+
+    struct CachedLogin
+    {
+        QByteArray passwordHash;
+        UserId userId;
+        qint64 expires;
+    };
+
+    void forgetCachedLogins(UserId userId);
+
+    QThreadPool _authThreadPool;
+    QMutex _loginCacheMutex;
+    QHash<QString, CachedLogin> _loginCache;
+    QByteArray _loginCacheSalt;
+    quint64 _loginCacheGeneration{0};  ///< Bumped whenever cached logins are invalidated
 
     bool _initialized{false};
     bool _configured{false};
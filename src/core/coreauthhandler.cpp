@@ -20,11 +20,39 @@
 
 #include "coreauthhandler.h"
 
+#include <utility>
+
 #include <QtEndian>
 
+#include <QRunnable>
 #include <QSslSocket>
 
 #include "core.h"
+#include "metrics.h"
+
+// Checks login credentials on Core's auth thread pool; the result is delivered to the handler's thread
+class LoginTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    LoginTask(const QString& user, const QString& password)
+        : _user(user)
+        , _password(password)
+    {
+        // We delete ourselves once the result has been delivered
+        setAutoDelete(false);
+    }
+
+    void run() override { emit finished(_user, Core::authenticateLogin(_user, _password)); }
+
+signals:
+    void finished(const QString& user, UserId uid);
+
+private:
+    QString _user;
+    QString _password;
+};
 
 CoreAuthHandler::CoreAuthHandler(QSslSocket* socket, QObject* parent)
     : AuthHandler(parent)
@@ -36,6 +64,7 @@ CoreAuthHandler::CoreAuthHandler(QSslSocket* socket, QObject* parent)
     , _magicReceived(false)
     , _legacy(false)
     , _clientRegistered(false)
+    , _loginPending(false)
     , _connectionFeatures(0)
 {
     setSocket(socket);
@@ -90,6 +119,7 @@ void CoreAuthHandler::onReadyRead()
                                                        this,
                                                        socket(),
                                                        Compressor::NoCompression,
+                                                       Compressor::Deflate,
                                                        this);
             connect(peer, &RemotePeer::protocolVersionMismatch, this, &CoreAuthHandler::onProtocolVersionMismatch);
             setPeer(peer);
@@ -101,8 +131,23 @@ void CoreAuthHandler::onReadyRead()
         // figure out which connection features we'll use based on the client's support
         if (Core::sslSupported() && (features & Protocol::Encryption))
             _connectionFeatures |= Protocol::Encryption;
-        if (features & Protocol::Compression)
+        if (features & Protocol::Compression) {
             _connectionFeatures |= Protocol::Compression;
+            // Use the configured algorithm if the client supports it, or else the next best one both sides support
+            QList<QPair<Compressor::Algorithm, Protocol::Feature>> algorithms{{Compressor::Zstd, Protocol::ZstdCompression},
+                                                                             {Compressor::Lz4, Protocol::Lz4Compression}};
+            const QString preferred = Quassel::optionValue("compression");
+            if (preferred == "lz4")
+                std::swap(algorithms[0], algorithms[1]);
+            else if (preferred == "deflate")
+                algorithms.clear();
+            for (const auto& algorithm : algorithms) {
+                if ((features & algorithm.second) && Compressor::isSupported(algorithm.first)) {
+                    _connectionFeatures |= algorithm.second;
+                    break;
+                }
+            }
+        }
 
         socket()->read((char*)&magic, 4);  // read the 4 bytes we've just peeked at
     }
@@ -119,12 +164,23 @@ void CoreAuthHandler::onReadyRead()
 
         if (data >= 0x80000000) {  // last protocol
             Compressor::CompressionLevel level;
-            if (_connectionFeatures & Protocol::Compression)
+            Compressor::Algorithm algorithm = Compressor::Deflate;
+            if (_connectionFeatures & Protocol::ZstdCompression) {
+                // zstd's default level already beats deflate's best one, at a fraction of the CPU cost
+                level = Compressor::DefaultCompression;
+                algorithm = Compressor::Zstd;
+            }
+            else if (_connectionFeatures & Protocol::Lz4Compression) {
+                // LZ4's fast mode is meant for cores that are short on CPU, so don't go for its costly HC levels
+                level = Compressor::DefaultCompression;
+                algorithm = Compressor::Lz4;
+            }
+            else if (_connectionFeatures & Protocol::Compression)
                 level = Compressor::BestCompression;
             else
                 level = Compressor::NoCompression;
 
-            RemotePeer* peer = PeerFactory::createPeer(_supportedProtos, this, socket(), level, this);
+            RemotePeer* peer = PeerFactory::createPeer(_supportedProtos, this, socket(), level, algorithm, this);
             if (!peer) {
                 qWarning() << "Received invalid handshake data from client" << hostAddress().toString();
                 close();
@@ -257,39 +313,58 @@ void CoreAuthHandler::handle(const Protocol::Login& msg)
         return;
     }
 
-    // First attempt local auth using the real username and password.
-    // If that fails, move onto the auth provider.
-
-    // Check to see if the user has the "Database" authenticator configured.
-    UserId uid = 0;
-    if (Core::getUserAuthenticator(msg.user) == "Database") {
-        uid = Core::validateUser(msg.user, msg.password);
+    if (_loginPending) {
+        // Answer the attempt once the current one has been validated. Only the latest one is kept, any attempt it
+        // replaces is answered right away, so that every Login gets a reply.
+        if (_queuedLogin) {
+            _peer->dispatch(Protocol::LoginFailed(tr("<b>Login attempt superseded!</b><br>A newer login attempt replaced this one.")));
+        }
+        _queuedLogin.reset(new Protocol::Login(msg));
+        return;
     }
 
-    // If they did not, *or* if the database login fails, try to use a different authenticator.
-    // TODO: this logic should likely be moved into Core::authenticateUser in the future.
-    // Right now a core can only have one authenticator configured; this might be something
-    // to change in the future.
-    if (uid == 0) {
-        uid = Core::authenticateUser(msg.user, msg.password);
-    }
+    startLoginValidation(msg);
+}
+
+void CoreAuthHandler::startLoginValidation(const Protocol::Login& msg)
+{
+    // Hashing passwords and talking to LDAP can take a while, don't block the main thread on it
+    _loginPending = true;
+    _loginTimer.start();
+
+    auto* task = new LoginTask(msg.user, msg.password);
+    connect(task, &LoginTask::finished, this, &CoreAuthHandler::onLoginValidated);
+    connect(task, &LoginTask::finished, task, &QObject::deleteLater);
+    Core::authThreadPool()->start(task);
+}
+
+void CoreAuthHandler::onLoginValidated(const QString& user, UserId uid)
+{
+    _loginPending = false;
+    Metrics::loginDuration().observe(_loginTimer.nsecsElapsed());
 
     if (uid == 0) {
-        qInfo() << qPrintable(tr("Invalid login attempt from %1 as \"%2\"").arg(hostAddress().toString(), msg.user));
+        qInfo() << qPrintable(tr("Invalid login attempt from %1 as \"%2\"").arg(hostAddress().toString(), user));
         _peer->dispatch(Protocol::LoginFailed(tr(
             "<b>Invalid username or password!</b><br>The username/password combination you supplied could not be found in the database.")));
         if (_metricsServer) {
-            _metricsServer->addLoginAttempt(msg.user, false);
+            _metricsServer->addLoginAttempt(user, false);
+        }
+        if (_queuedLogin) {
+            std::unique_ptr<Protocol::Login> queuedLogin = std::move(_queuedLogin);
+            startLoginValidation(*queuedLogin);
         }
         return;
     }
+    // The client is logged in now, a login attempt that came in meanwhile needs no answer
+    _queuedLogin.reset();
     _peer->dispatch(Protocol::LoginSuccess());
     if (_metricsServer) {
         _metricsServer->addLoginAttempt(uid, true);
     }
 
     qInfo() << qPrintable(tr("Client %1 initialized and authenticated successfully as \"%2\" (UserId: %3).")
-                              .arg(_peer->address(), msg.user, QString::number(uid.toInt())));
+                              .arg(_peer->address(), user, QString::number(uid.toInt())));
 
     const auto& clientFeatures = _peer->features();
     auto unsupported = clientFeatures.toStringList(false);
@@ -344,3 +419,5 @@ void CoreAuthHandler::onSslErrors()
 {
     socket()->ignoreSslErrors();
 }
+
+#include "coreauthhandler.moc"
@@ -20,6 +20,10 @@
 
 #pragma once
 
+#include <memory>
+
+#include <QElapsedTimer>
+
 #include "authhandler.h"
 #include "metricsserver.h"
 #include "peerfactory.h"
@@ -51,10 +55,13 @@ private:
     void startSsl();
 
     bool checkClientRegistered();
+    void startLoginValidation(const Protocol::Login& msg);
 
 private slots:
     void onReadyRead();
 
+    void onLoginValidated(const QString& user, UserId uid);
+
     void onSslErrors();
 
     // only in legacy mode
@@ -70,6 +77,9 @@ private:
     bool _magicReceived;
     bool _legacy;
     bool _clientRegistered;
+    bool _loginPending;
+    std::unique_ptr<Protocol::Login> _queuedLogin;  ///< Login received while another one was being validated
+    QElapsedTimer _loginTimer;
     quint8 _connectionFeatures;
     QVector<PeerFactory::ProtoDescriptor> _supportedProtos;
 };
@@ -22,12 +22,27 @@
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 #include <QDebug>
+#include <QTimer>
 
 #include "core.h"
 #include "coresession.h"
 
+namespace {
+
+// Number of buffers served from one storage transaction, and sent back in one reply, for batched requests
+constexpr size_t batchChunkSize = 32;
+
+// Maximum number of messages per page of a streamed backlog reply
+constexpr int backlogPageSize = 1000;
+
+// Streamed backlog pages and batch chunks are held back while more than this many bytes are waiting to be written to the peer
+constexpr qint64 maxPendingBytes = 1024 * 1024;
+
+}  // namespace
+
 CoreBacklogManager::CoreBacklogManager(CoreSession* coreSession)
     : BacklogManager(coreSession)
     , _coreSession(coreSession)
@@ -123,6 +138,17 @@ QVariantList CoreBacklogManager::requestBacklogForward(BufferId bufferId, MsgId
 
 QVariantList CoreBacklogManager::requestBacklogAll(MsgId first, MsgId last, int limit, int additional)
 {
+    Peer* peer = SignalProxy::current()->sourcePeer();
+    if (peer && peer->hasFeature(Quassel::Feature::BacklogStreaming)) {
+        BacklogStream stream;
+        stream.peer = peer;
+        stream.first = first;
+        stream.last = last;
+        stream.limit = limit;
+        stream.additional = additional;
+        return startBacklogStream(std::move(stream));
+    }
+
     QVariantList backlog;
     auto msgList = Core::requestAllMsgs(coreSession()->user(), first, last, limit);
 
@@ -154,6 +180,20 @@ QVariantList CoreBacklogManager::requestBacklogAll(MsgId first, MsgId last, int
 
 QVariantList CoreBacklogManager::requestBacklogAllFiltered(MsgId first, MsgId last, int limit, int additional, int type, int flags)
 {
+    Peer* peer = SignalProxy::current()->sourcePeer();
+    if (peer && peer->hasFeature(Quassel::Feature::BacklogStreaming)) {
+        BacklogStream stream;
+        stream.peer = peer;
+        stream.filtered = true;
+        stream.type = type;
+        stream.flags = flags;
+        stream.first = first;
+        stream.last = last;
+        stream.limit = limit;
+        stream.additional = additional;
+        return startBacklogStream(std::move(stream));
+    }
+
     QVariantList backlog;
     auto msgList = Core::requestAllMsgsFiltered(coreSession()->user(), first, last, limit, Message::Types{type}, Message::Flags{flags});
 
@@ -182,3 +222,245 @@ QVariantList CoreBacklogManager::requestBacklogAllFiltered(MsgId first, MsgId la
 
     return backlog;
 }
+
+void CoreBacklogManager::requestBacklogBatch(QVariantList requests)
+{
+    Peer* peer = SignalProxy::current()->sourcePeer();
+
+    BacklogBatch batch;
+    batch.peer = peer;
+    batch.requests.reserve(requests.size());
+    batch.additionals.reserve(requests.size());
+    QVariantList skipped;
+    for (const QVariant& request : requests) {
+        QVariantList params = request.toList();
+        if (params.count() < 4) {
+            qWarning() << "CoreBacklogManager::requestBacklogBatch(): ignoring malformed request" << request;
+            // The client still waits for an answer for this buffer
+            skipped << QVariant(QVariantList{QVariant::fromValue(params.value(0).value<BufferId>()), QVariantList{}});
+            continue;
+        }
+        batch.requests.push_back({params[0].value<BufferId>(), params[1].value<MsgId>(), params[2].value<MsgId>(), params[3].toInt()});
+        batch.additionals.push_back(params.value(4).toInt());
+    }
+
+    if (!skipped.isEmpty())
+        SignalProxy::current()->restrictTargetPeers(peer, [&] { SYNC_OTHER(receiveBacklogBatch, ARG(skipped)) });
+
+    if (!peer || batch.requests.empty())
+        return;
+
+    // Chunks are queried and sent one at a time from the event loop, as the connection drains
+    connect(peer, &Peer::bytesWritten, this, &CoreBacklogManager::scheduleBacklogStreams, Qt::UniqueConnection);
+    _backlogBatches.push_back(std::move(batch));
+    scheduleBacklogStreams();
+}
+
+void CoreBacklogManager::sendNextBatchChunk(BacklogBatch& batch)
+{
+    size_t begin = batch.next;
+    size_t end = std::min(batch.requests.size(), begin + batchChunkSize);
+    batch.next = end;
+
+    std::vector<Storage::MsgRequest> chunk(batch.requests.begin() + begin, batch.requests.begin() + end);
+    auto results = Core::requestMsgsBatch(coreSession()->user(), chunk);
+
+    // Collect the follow-up requests for additional messages, see requestBacklog()
+    std::vector<Storage::MsgRequest> additionalChunk;
+    std::vector<size_t> additionalIndexes;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        const Storage::MsgRequest& request = chunk[i];
+        int additional = batch.additionals[begin + i];
+        if (!additional || request.limit == 0)
+            continue;
+
+        const auto& msgList = results[i];
+        MsgId oldestMessage = request.first;
+        if (!msgList.empty())
+            oldestMessage = std::min(msgList.front().msgId(), msgList.back().msgId());
+
+        // only fetch additional messages if they continue seamlessly
+        MsgId last = request.first != -1 ? request.first : oldestMessage;
+        if (last == oldestMessage) {
+            additionalChunk.push_back({request.bufferId, MsgId(-1), last, additional});
+            additionalIndexes.push_back(i);
+        }
+    }
+    if (!additionalChunk.empty()) {
+        auto additionalResults = Core::requestMsgsBatch(coreSession()->user(), additionalChunk);
+        for (size_t i = 0; i < additionalIndexes.size(); ++i) {
+            auto& msgList = results[additionalIndexes[i]];
+            std::move(additionalResults[i].begin(), additionalResults[i].end(), std::back_inserter(msgList));
+        }
+    }
+
+    QVariantList backlogs;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        QVariantList backlog;
+        std::transform(results[i].cbegin(), results[i].cend(), std::back_inserter(backlog), [](auto&& msg) {
+            return QVariant::fromValue(msg);
+        });
+        backlogs << QVariant(QVariantList{QVariant::fromValue(chunk[i].bufferId), backlog});
+    }
+    coreSession()->signalProxy()->restrictTargetPeers(batch.peer.data(), [&] { SYNC_OTHER(receiveBacklogBatch, ARG(backlogs)) });
+}
+
+QVariantList CoreBacklogManager::startBacklogStream(BacklogStream stream)
+{
+    stream.cursor = stream.last;
+    stream.remaining = stream.limit;
+
+    // The first page goes out as the regular reply to the request, the others follow as the connection drains.
+    // Even a stream that is already done stays queued, so that its end is announced after the reply.
+    QVariantList page = nextBacklogPage(stream);
+    connect(stream.peer, &Peer::bytesWritten, this, &CoreBacklogManager::scheduleBacklogStreams, Qt::UniqueConnection);
+    _backlogStreams.push_back(std::move(stream));
+    scheduleBacklogStreams();
+    return page;
+}
+
+QVariantList CoreBacklogManager::nextBacklogPage(BacklogStream& stream)
+{
+    int pageLimit = stream.remaining < 0 ? backlogPageSize : std::min(stream.remaining, backlogPageSize);
+    MsgId pageFirst = stream.additionalPhase ? MsgId(-1) : stream.first;
+
+    std::vector<Message> msgList;
+    if (stream.filtered) {
+        msgList = Core::requestAllMsgsFiltered(coreSession()->user(),
+                                               pageFirst,
+                                               stream.cursor,
+                                               pageLimit,
+                                               Message::Types{stream.type},
+                                               Message::Flags{stream.flags});
+    }
+    else {
+        msgList = Core::requestAllMsgs(coreSession()->user(), pageFirst, stream.cursor, pageLimit);
+    }
+
+    QVariantList page;
+    std::transform(msgList.cbegin(), msgList.cend(), std::back_inserter(page), [](auto&& msg) {
+        return QVariant::fromValue(msg);
+    });
+
+    if (!msgList.empty()) {
+        stream.cursor = std::min(msgList.front().msgId(), msgList.back().msgId());
+        stream.oldest = stream.cursor;
+    }
+    if (stream.remaining > 0)
+        stream.remaining -= std::min(stream.remaining, int(msgList.size()));
+
+    if (int(msgList.size()) < pageLimit || stream.remaining == 0) {
+        if (!stream.additionalPhase && stream.additional) {
+            // Continue with the additional messages, see requestBacklogAll()
+            stream.additionalPhase = true;
+            stream.cursor = stream.first != -1 ? stream.first : stream.oldest;
+            stream.remaining = stream.additional;
+        }
+        else {
+            stream.done = true;
+        }
+    }
+    return page;
+}
+
+void CoreBacklogManager::scheduleBacklogStreams()
+{
+    if ((_backlogStreams.empty() && _backlogBatches.empty()) || _backlogStreamsScheduled)
+        return;
+
+    // Pages and chunks are sent from the event loop, so other requests and IRC traffic are handled in between
+    _backlogStreamsScheduled = true;
+    QTimer::singleShot(0, this, &CoreBacklogManager::processBacklogStreams);
+}
+
+void CoreBacklogManager::processBacklogStreams()
+{
+    _backlogStreamsScheduled = false;
+
+    bool ready = false;
+    for (auto it = _backlogStreams.begin(); it != _backlogStreams.end();) {
+        BacklogStream& stream = *it;
+        if (!stream.peer || !stream.peer->isOpen()) {
+            it = _backlogStreams.erase(it);
+            continue;
+        }
+        if (stream.done) {
+            finishBacklogStream(stream);
+            it = _backlogStreams.erase(it);
+            continue;
+        }
+        if (stream.peer->bytesToWrite() > maxPendingBytes) {
+            // The peer's bytesWritten() signal will get us going again
+            ++it;
+            continue;
+        }
+
+        QVariantList page = nextBacklogPage(stream);
+        coreSession()->signalProxy()->restrictTargetPeers(stream.peer.data(), [&] {
+            if (stream.filtered) {
+                SYNC_OTHER(receiveBacklogAllFiltered,
+                           ARG(stream.first),
+                           ARG(stream.last),
+                           ARG(stream.limit),
+                           ARG(stream.additional),
+                           ARG(stream.type),
+                           ARG(stream.flags),
+                           ARG(page))
+            }
+            else {
+                SYNC_OTHER(receiveBacklogAll, ARG(stream.first), ARG(stream.last), ARG(stream.limit), ARG(stream.additional), ARG(page))
+            }
+        });
+
+        if (stream.done) {
+            finishBacklogStream(stream);
+            it = _backlogStreams.erase(it);
+        }
+        else {
+            ready = true;
+            ++it;
+        }
+    }
+
+    for (auto it = _backlogBatches.begin(); it != _backlogBatches.end();) {
+        BacklogBatch& batch = *it;
+        if (!batch.peer || !batch.peer->isOpen()) {
+            it = _backlogBatches.erase(it);
+            continue;
+        }
+        if (batch.peer->bytesToWrite() > maxPendingBytes) {
+            ++it;
+            continue;
+        }
+
+        sendNextBatchChunk(batch);
+        if (batch.next >= batch.requests.size()) {
+            it = _backlogBatches.erase(it);
+        }
+        else {
+            ready = true;
+            ++it;
+        }
+    }
+
+    if (ready)
+        scheduleBacklogStreams();
+}
+
+void CoreBacklogManager::finishBacklogStream(const BacklogStream& stream)
+{
+    coreSession()->signalProxy()->restrictTargetPeers(stream.peer.data(), [&] {
+        if (stream.filtered) {
+            SYNC_OTHER(receiveBacklogAllFilteredComplete,
+                       ARG(stream.first),
+                       ARG(stream.last),
+                       ARG(stream.limit),
+                       ARG(stream.additional),
+                       ARG(stream.type),
+                       ARG(stream.flags))
+        }
+        else {
+            SYNC_OTHER(receiveBacklogAllComplete, ARG(stream.first), ARG(stream.last), ARG(stream.limit), ARG(stream.additional))
+        }
+    });
+}
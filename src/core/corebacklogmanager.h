@@ -20,7 +20,14 @@
 
 #pragma once
 
+#include <list>
+#include <vector>
+
+#include <QPointer>
+
 #include "backlogmanager.h"
+#include "peer.h"
+#include "storage.h"
 
 class CoreSession;
 
@@ -42,7 +49,56 @@ public slots:
     QVariantList requestBacklogAll(MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0) override;
     QVariantList requestBacklogAllFiltered(
         MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0, int type = -1, int flags = -1) override;
+    void requestBacklogBatch(QVariantList requests) override;
+
+private:
+    /**
+     * State of a requestBacklogAll*() reply that is sent in several pages.
+     *
+     * Pages are fetched in descending MsgId order, each one continuing below the oldest message of the previous
+     * page. Once the requested range is exhausted, the stream continues with the additional messages, if any.
+     */
+    struct BacklogStream
+    {
+        QPointer<Peer> peer;
+        bool filtered{false};
+        int type{-1};
+        int flags{-1};
+
+        // Parameters of the original request, echoed in every page
+        MsgId first;
+        MsgId last;
+        int limit{-1};
+        int additional{0};
+
+        MsgId cursor;         ///< Exclusive upper bound of the next page
+        MsgId oldest{-1};     ///< Oldest message sent so far, -1 if none
+        int remaining{-1};    ///< Messages left in the current phase, negative for unlimited
+        bool additionalPhase{false};
+        bool done{false};
+    };
+
+    /**
+     * State of a requestBacklogBatch() reply, which is sent in chunks of several buffers each.
+     */
+    struct BacklogBatch
+    {
+        QPointer<Peer> peer;
+        std::vector<Storage::MsgRequest> requests;
+        std::vector<int> additionals;  ///< Additional messages for each request, see requestBacklog()
+        size_t next{0};                ///< Index of the first request of the next chunk
+    };
+
+    QVariantList startBacklogStream(BacklogStream stream);
+    QVariantList nextBacklogPage(BacklogStream& stream);
+    void scheduleBacklogStreams();
+    void processBacklogStreams();
+    void finishBacklogStream(const BacklogStream& stream);
+    void sendNextBatchChunk(BacklogBatch& batch);
 
 private:
     CoreSession* _coreSession;
+    std::list<BacklogStream> _backlogStreams;
+    std::list<BacklogBatch> _backlogBatches;
+    bool _backlogStreamsScheduled{false};
 };
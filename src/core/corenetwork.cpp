@@ -25,6 +25,7 @@
 #include <QDebug>
 #include <QHostInfo>
 #include <QTextBoundaryFinder>
+#include <QVector>
 
 #include "core.h"
 #include "coreidentity.h"
@@ -41,6 +42,7 @@ CoreNetwork::CoreNetwork(const NetworkId& networkid, CoreSession* session)
     , _coreSession(session)
     , _userInputHandler(new CoreUserInputHandler(this))
     , _metricsServer(Core::instance()->metricsServer())
+    , _userMetrics(_metricsServer ? _metricsServer->userMetrics(session->user()) : nullptr)
     , _autoReconnectCount(0)
     , _quitRequested(false)
     , _disconnectExpected(false)
@@ -268,6 +270,7 @@ void CoreNetwork::connectToIrc(bool reconnecting)
         // hostname of the server. Qt's DNS cache also isn't used by the proxy so we don't need to refresh the entry.
         QHostInfo::fromName(server.host);
     }
+    _readBuffer.clear();
     if (server.useSsl) {
         CoreIdentity* identity = identityPtr();
         if (identity) {
@@ -293,7 +296,7 @@ void CoreNetwork::disconnectFromIrc(bool requested, const QString& reason, bool
     disablePingTimeout();
     _msgQueue.clear();
     if (_metricsServer) {
-        _metricsServer->messageQueue(userId(), 0);
+        _metricsServer->messageQueue(_userMetrics, 0);
     }
 
     IrcUser* me_ = me();
@@ -372,7 +375,7 @@ void CoreNetwork::putRawLine(const QByteArray& s, bool prepend)
             _msgQueue.append(s);
         }
         if (_metricsServer) {
-            _metricsServer->messageQueue(userId(), _msgQueue.size());
+            _metricsServer->messageQueue(_userMetrics, _msgQueue.size());
         }
     }
 }
@@ -511,19 +514,40 @@ void CoreNetwork::setMyNick(const QString& mynick)
 
 void CoreNetwork::onSocketHasData()
 {
-    while (socket.canReadLine()) {
-        QByteArray s = socket.readLine();
-        if (_metricsServer) {
-            _metricsServer->receiveDataNetwork(userId(), s.size());
-        }
-        if (s.endsWith("\r\n"))
-            s.chop(2);
-        else if (s.endsWith("\n"))
-            s.chop(1);
-        NetworkDataEvent* event = new NetworkDataEvent(EventManager::NetworkIncoming, this, s);
-        event->setTimestamp(QDateTime::currentDateTimeUtc());
+    // Take everything that arrived in one go and split it into lines here, rather than asking the socket
+    // for one line at a time
+    const QByteArray data = socket.readAll();
+    if (data.isEmpty())
+        return;
+    if (_metricsServer) {
+        _metricsServer->receiveDataNetwork(_userMetrics, data.size());
+    }
+
+    QByteArray buffer = _readBuffer.isEmpty() ? data : _readBuffer + data;
+    _readBuffer.clear();
+
+    // Lines from the same read arrived together, so they share a timestamp
+    const QDateTime timestamp = QDateTime::currentDateTimeUtc();
+    uint64_t lines = 0;
+    int start = 0;
+    int end;
+    // Handling a line may close the socket, in which case the rest is dropped just like the socket's own buffer
+    while (socket.isOpen() && (end = buffer.indexOf('\n', start)) != -1) {
+        int length = end - start;
+        if (length > 0 && buffer.at(end - 1) == '\r')
+            length--;
+        NetworkDataEvent* event = new NetworkDataEvent(EventManager::NetworkIncoming, this, buffer.mid(start, length));
+        event->setTimestamp(timestamp);
+        start = end + 1;
+        lines++;
         emit newEvent(event);
     }
+    if (socket.isOpen() && start < buffer.size())
+        _readBuffer = buffer.mid(start);
+
+    if (_metricsServer && lines > 0) {
+        _metricsServer->receiveLinesNetwork(_userMetrics, lines);
+    }
 }
 
 void CoreNetwork::onSocketError(QAbstractSocket::SocketError error)
@@ -612,8 +636,9 @@ void CoreNetwork::onSocketDisconnected()
 {
     disablePingTimeout();
     _msgQueue.clear();
+    _readBuffer.clear();
     if (_metricsServer) {
-        _metricsServer->messageQueue(userId(), 0);
+        _metricsServer->messageQueue(_userMetrics, 0);
     }
 
     _autoWhoCycleTimer.stop();
@@ -1578,7 +1603,7 @@ void CoreNetwork::fillBucketAndProcessQueue()
     while (!_msgQueue.empty() && _tokenBucket > 0) {
         writeToSocket(_msgQueue.takeFirst());
         if (_metricsServer) {
-            _metricsServer->messageQueue(userId(), _msgQueue.size());
+            _metricsServer->messageQueue(_userMetrics, _msgQueue.size());
         }
     }
 }
@@ -1593,7 +1618,7 @@ void CoreNetwork::writeToSocket(const QByteArray& data)
     socket.write(data);
     socket.write("\r\n");
     if (_metricsServer) {
-        _metricsServer->transmitDataNetwork(userId(), data.size() + 2);
+        _metricsServer->transmitDataNetwork(_userMetrics, data.size() + 2);
     }
     if (!_skipMessageRates) {
         // Only subtract from the token bucket if message rate limiting is enabled
@@ -1657,6 +1682,15 @@ void CoreNetwork::requestSetNetworkInfo(const NetworkInfo& info)
 QList<QList<QByteArray>> CoreNetwork::splitMessage(const QString& cmd,
                                                    const QString& message,
                                                    const std::function<QList<QByteArray>(QString&)>& cmdGenerator)
+{
+    return splitMessage(message, cmdGenerator, [this, &cmd](const QList<QByteArray>& params) {
+        return userInputHandler()->lastParamOverrun(cmd, params);
+    });
+}
+
+QList<QList<QByteArray>> CoreNetwork::splitMessage(const QString& message,
+                                                   const std::function<QList<QByteArray>(QString&)>& cmdGenerator,
+                                                   const std::function<int(const QList<QByteArray>&)>& overrunFunc)
 {
     QString wrkMsg(message);
     QList<QList<QByteArray>> msgsToSend;
@@ -1668,64 +1702,55 @@ QList<QList<QByteArray>> CoreNetwork::splitMessage(const QString& cmd,
         // and encrypt (if applicable) the message, since different callers might
         // want to use different encoding or encode different values.
         int splitPos = wrkMsg.size();
-        QList<QByteArray> initialSplitMsgEnc = cmdGenerator(wrkMsg);
-        int initialOverrun = userInputHandler()->lastParamOverrun(cmd, initialSplitMsgEnc);
-
-        if (initialOverrun) {
-            // If the message was too long to be sent, first try splitting it along
-            // word boundaries with QTextBoundaryFinder.
-            QString splitMsg(wrkMsg);
-            QTextBoundaryFinder qtbf(QTextBoundaryFinder::Word, splitMsg);
-            qtbf.setPosition(initialSplitMsgEnc[1].size() - initialOverrun);
-            QList<QByteArray> splitMsgEnc;
-            int overrun = initialOverrun;
-
-            while (overrun) {
-                splitPos = qtbf.toPreviousBoundary();
-
-                // splitPos==-1 means the QTBF couldn't find a split point at all and
-                // splitPos==0 means the QTBF could only find a boundary at the beginning of
-                // the string.  Neither one of these works for us.
-                if (splitPos > 0) {
-                    // If a split point could be found, split the message there, calculate the
-                    // overrun, and continue with the loop.
-                    splitMsg = splitMsg.left(splitPos);
-                    splitMsgEnc = cmdGenerator(splitMsg);
-                    overrun = userInputHandler()->lastParamOverrun(cmd, splitMsgEnc);
-                }
-                else {
-                    // If a split point could not be found (the beginning of the message
-                    // is reached without finding a split point short enough to send) and we
-                    // are still in Word mode, switch to Grapheme mode.  We also need to restore
-                    // the full wrkMsg to splitMsg, since splitMsg may have been cut down during
-                    // the previous attempt to find a split point.
-                    if (qtbf.type() == QTextBoundaryFinder::Word) {
-                        splitMsg = wrkMsg;
-                        splitPos = splitMsg.size();
-                        QTextBoundaryFinder graphemeQtbf(QTextBoundaryFinder::Grapheme, splitMsg);
-                        graphemeQtbf.setPosition(initialSplitMsgEnc[1].size() - initialOverrun);
-                        qtbf = graphemeQtbf;
+        QList<QByteArray> splitMsgEnc = cmdGenerator(wrkMsg);
+        int overrun = overrunFunc(splitMsgEnc);
+
+        if (overrun) {
+            // Every character takes at least one byte, so no split point past this can fit
+            int maxPos = qBound(0, splitMsgEnc.last().size() - overrun, wrkMsg.size());
+
+            // If the message was too long to be sent, first try splitting it along word boundaries,
+            // then along grapheme boundaries.  Encoding (and possibly encrypting) is by far the most
+            // expensive part, so rather than trying one boundary after the other, binary search for
+            // the last one that still fits; encoded length never decreases with more text.
+            splitPos = 0;
+            for (auto type : {QTextBoundaryFinder::Word, QTextBoundaryFinder::Grapheme}) {
+                QVector<int> boundaries;
+                QTextBoundaryFinder qtbf(type, wrkMsg);
+                // A boundary at the very beginning doesn't help us
+                for (int pos = qtbf.toNextBoundary(); pos > 0 && pos <= maxPos; pos = qtbf.toNextBoundary())
+                    boundaries.append(pos);
+
+                int low = 0;
+                int high = boundaries.size() - 1;
+                while (low <= high) {
+                    int mid = (low + high) / 2;
+                    QString splitMsg = wrkMsg.left(boundaries[mid]);
+                    QList<QByteArray> candidateEnc = cmdGenerator(splitMsg);
+                    if (overrunFunc(candidateEnc) == 0) {
+                        splitPos = boundaries[mid];
+                        splitMsgEnc = candidateEnc;
+                        low = mid + 1;
                     }
                     else {
-                        // If the QTBF fails to find a split point in Grapheme mode, we give up.
-                        // This should never happen, but it should be handled anyway.
-                        qWarning() << "Unexpected failure to split message!";
-                        return msgsToSend;
+                        high = mid - 1;
                     }
                 }
+                if (splitPos > 0)
+                    break;
             }
 
-            // Once a message of sendable length has been found, remove it from the wrkMsg and
-            // add it to the list of messages to be sent.
-            wrkMsg.remove(0, splitPos);
-            msgsToSend.append(splitMsgEnc);
-        }
-        else {
-            // If the entire remaining message is short enough to be sent all at once, remove
-            // it from the wrkMsg and add it to the list of messages to be sent.
-            wrkMsg.remove(0, splitPos);
-            msgsToSend.append(initialSplitMsgEnc);
+            if (splitPos == 0) {
+                // If no split point is short enough even in Grapheme mode, we give up.
+                // This should never happen, but it should be handled anyway.
+                qWarning() << "Unexpected failure to split message!";
+                return msgsToSend;
+            }
         }
+
+        // Remove what's about to be sent from wrkMsg and add it to the list of messages to be sent.
+        wrkMsg.remove(0, splitPos);
+        msgsToSend.append(splitMsgEnc);
     } while (wrkMsg.size() > 0);
 
     return msgsToSend;
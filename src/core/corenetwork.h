@@ -35,6 +35,7 @@
 #include "coresession.h"
 #include "irccap.h"
 #include "irctag.h"
+#include "metricsserver.h"
 #include "network.h"
 
 class CoreIdentity;
@@ -129,6 +130,20 @@ public:
                                           const QString& message,
                                           const std::function<QList<QByteArray>(QString&)>& cmdGenerator);
 
+    /**
+     * Splits a message into parts that each fit into a single IRC command
+     *
+     * Messages are split along word boundaries if possible, otherwise along grapheme boundaries.
+     *
+     * @param message      Message to split
+     * @param cmdGenerator Turns a part of the message into the encoded (and possibly encrypted) command parameters
+     * @param overrunFunc  Returns by how many bytes the given parameters exceed the maximum command length, or 0 if they fit
+     * @return Encoded parameters for each part of the message
+     */
+    static QList<QList<QByteArray>> splitMessage(const QString& message,
+                                                 const std::function<QList<QByteArray>(QString&)>& cmdGenerator,
+                                                 const std::function<int(const QList<QByteArray>&)>& overrunFunc);
+
     // IRCv3 capability negotiation
 
     /**
@@ -508,9 +523,11 @@ private:
 
     QSslSocket socket;
     qint64 _socketId{0};
+    QByteArray _readBuffer;  ///< Incomplete line left over from the last socket read
 
     CoreUserInputHandler* _userInputHandler;
     MetricsServer* _metricsServer;
+    MetricsServer::UserMetrics* _userMetrics;  ///< Looked up once, so the hot paths don't need to
 
     QHash<QString, QString> _channelKeys;  // stores persistent channels and their passwords, if any
 
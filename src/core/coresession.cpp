@@ -20,6 +20,7 @@
 
 #include "coresession.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "core.h"
@@ -77,17 +78,33 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
     , _sessionEventProcessor(new CoreSessionEventProcessor(this))
     , _ctcpParser(new CtcpParser(this))
     , _ircParser(new IrcParser(this))
+    , _bufferInfoCache([this](NetworkId networkId, BufferInfo::Type type, const QString& bufferName, bool create) {
+        return Core::bufferInfo(user(), networkId, type, bufferName, create);
+    })
     , _processMessages(false)
     , _ignoreListManager(this)
     , _highlightRuleManager(this)
     , _metricsServer(Core::instance()->metricsServer())
 {
+    if (Core::instance()->messageWriter()) {
+        Core::instance()->messageWriter()->attach(this);
+    }
+
     SignalProxy* p = signalProxy();
     p->setHeartBeatInterval(30);
     p->setMaxHeartBeatCount(60);  // 30 mins until we throw a dead socket out
 
     connect(p, &SignalProxy::peerRemoved, this, &CoreSession::removeClient);
 
+    // Keep the BufferInfo cache in sync with the buffers. Removal happens in the background, so a buffer is evicted as soon as
+    // its removal is requested, rather than only after the storage backend has deleted it.
+    connect(_bufferSyncer, &CoreBufferSyncer::doRemoveBuffer, this, [this](BufferId bufferId) { _bufferInfoCache.beginRemoval(bufferId); });
+    connect(_bufferSyncer, &BufferSyncer::bufferRemoved, this, [this](BufferId bufferId) { _bufferInfoCache.endRemoval(bufferId); });
+    connect(_bufferSyncer, &BufferSyncer::bufferRenamed, this, [this](BufferId bufferId) { _bufferInfoCache.evict(bufferId); });
+    connect(_bufferSyncer, &BufferSyncer::buffersPermanentlyMerged, this, [this](BufferId, BufferId bufferId2) {
+        _bufferInfoCache.evict(bufferId2);
+    });
+
     connect(p, &SignalProxy::connected, this, &CoreSession::clientsConnected);
     connect(p, &SignalProxy::disconnected, this, &CoreSession::clientsDisconnected);
 
@@ -155,6 +172,13 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
     }
 }
 
+CoreSession::~CoreSession()
+{
+    if (Core::instance()->messageWriter()) {
+        Core::instance()->messageWriter()->detach(this);
+    }
+}
+
 void CoreSession::shutdown()
 {
     saveSessionState();
@@ -340,7 +364,7 @@ void CoreSession::recvMessageFromServer(RawMessage msg)
     if (currentNetwork && _highlightRuleManager.match(msg, currentNetwork->myNick(), currentNetwork->identityPtr()->nicks()))
         msg.flags |= Message::Flag::Highlight;
 
-    _messageQueue << std::move(msg);
+    _messageQueue.push_back(std::move(msg));
     if (!_processMessages) {
         _processMessages = true;
         QCoreApplication::postEvent(this, new ProcessMessagesEvent());
@@ -375,6 +399,14 @@ std::vector<BufferInfo> CoreSession::buffers() const
 
 void CoreSession::customEvent(QEvent* event)
 {
+    if (event->type() == MessagesStoredEvent::EventId) {
+        auto* storedEvent = static_cast<MessagesStoredEvent*>(event);
+        if (storedEvent->success)
+            displayMessages(storedEvent->messages);
+        event->accept();
+        return;
+    }
+
     if (event->type() != QEvent::User)
         return;
 
@@ -382,99 +414,78 @@ void CoreSession::customEvent(QEvent* event)
     event->accept();
 }
 
+void CoreSession::storeMessages(MessageList messages)
+{
+    MessageWriter* writer = Core::instance()->messageWriter();
+    if (writer) {
+        writer->enqueue(this, std::move(messages));
+        return;
+    }
+
+    bool success = messages.count() == 1 ? Core::storeMessage(messages.first()) : Core::storeMessages(messages);
+    if (success)
+        displayMessages(messages);
+}
+
+void CoreSession::displayMessages(const MessageList& messages)
+{
+    // FIXME: extend protocol to a displayMessages(MessageList)
+    for (const Message& msg : messages) {
+        emit displayMsg(msg);
+    }
+}
+
 void CoreSession::processMessages()
 {
-    if (_messageQueue.count() == 1) {
-        const RawMessage& rawMsg = _messageQueue.first();
+    MessageList messages;
+    messages.reserve(static_cast<int>(_messageQueue.size()));
+    std::vector<const RawMessage*> redirectedMessages;  // list of Messages which don't enforce a buffer creation
+    for (const RawMessage& rawMsg : _messageQueue) {
         bool createBuffer = !(rawMsg.flags & Message::Redirected);
-        BufferInfo bufferInfo = Core::bufferInfo(user(), rawMsg.networkId, rawMsg.bufferType, rawMsg.target, createBuffer);
+        BufferInfo bufferInfo = _bufferInfoCache.lookup(rawMsg.networkId, rawMsg.bufferType, rawMsg.target, createBuffer);
         if (!bufferInfo.isValid()) {
             Q_ASSERT(!createBuffer);
-            bufferInfo = Core::bufferInfo(user(), rawMsg.networkId, BufferInfo::StatusBuffer, "");
+            redirectedMessages.push_back(&rawMsg);
+            continue;
         }
-        Message msg(rawMsg.timestamp,
-                    bufferInfo,
-                    rawMsg.type,
-                    rawMsg.text,
-                    rawMsg.sender,
-                    senderPrefixes(rawMsg.sender, bufferInfo),
-                    realName(rawMsg.sender, rawMsg.networkId),
-                    avatarUrl(rawMsg.sender, rawMsg.networkId),
-                    rawMsg.flags);
-        if (Core::storeMessage(msg))
-            emit displayMsg(msg);
+        messages << createMessage(rawMsg, bufferInfo);
     }
-    else {
-        QHash<NetworkId, QHash<QString, BufferInfo>> bufferInfoCache;
-        MessageList messages;
-        QList<RawMessage> redirectedMessages;  // list of Messages which don't enforce a buffer creation
-        BufferInfo bufferInfo;
-        for (int i = 0; i < _messageQueue.count(); i++) {
-            const RawMessage& rawMsg = _messageQueue.at(i);
-            if (bufferInfoCache.contains(rawMsg.networkId) && bufferInfoCache[rawMsg.networkId].contains(rawMsg.target)) {
-                bufferInfo = bufferInfoCache[rawMsg.networkId][rawMsg.target];
-            }
-            else {
-                bool createBuffer = !(rawMsg.flags & Message::Redirected);
-                bufferInfo = Core::bufferInfo(user(), rawMsg.networkId, rawMsg.bufferType, rawMsg.target, createBuffer);
-                if (!bufferInfo.isValid()) {
-                    Q_ASSERT(!createBuffer);
-                    redirectedMessages << rawMsg;
-                    continue;
-                }
-                bufferInfoCache[rawMsg.networkId][rawMsg.target] = bufferInfo;
-            }
-            Message msg(rawMsg.timestamp,
-                        bufferInfo,
-                        rawMsg.type,
-                        rawMsg.text,
-                        rawMsg.sender,
-                        senderPrefixes(rawMsg.sender, bufferInfo),
-                        realName(rawMsg.sender, rawMsg.networkId),
-                        avatarUrl(rawMsg.sender, rawMsg.networkId),
-                        rawMsg.flags);
-            messages << msg;
-        }
 
-        // recheck if there exists a buffer to store a redirected message in
-        for (int i = 0; i < redirectedMessages.count(); i++) {
-            const RawMessage& rawMsg = redirectedMessages.at(i);
-            if (bufferInfoCache.contains(rawMsg.networkId) && bufferInfoCache[rawMsg.networkId].contains(rawMsg.target)) {
-                bufferInfo = bufferInfoCache[rawMsg.networkId][rawMsg.target];
-            }
-            else {
-                // no luck -> we store them in the StatusBuffer
-                bufferInfo = Core::bufferInfo(user(), rawMsg.networkId, BufferInfo::StatusBuffer, "");
-                // add the StatusBuffer to the Cache in case there are more Messages for the original target
-                bufferInfoCache[rawMsg.networkId][rawMsg.target] = bufferInfo;
-            }
-            Message msg(rawMsg.timestamp,
-                        bufferInfo,
-                        rawMsg.type,
-                        rawMsg.text,
-                        rawMsg.sender,
-                        senderPrefixes(rawMsg.sender, bufferInfo),
-                        realName(rawMsg.sender, rawMsg.networkId),
-                        avatarUrl(rawMsg.sender, rawMsg.networkId),
-                        rawMsg.flags);
-            messages << msg;
-        }
-
-        if (Core::storeMessages(messages)) {
-            // FIXME: extend protocol to a displayMessages(MessageList)
-            for (int i = 0; i < messages.count(); i++) {
-                emit displayMsg(messages[i]);
-            }
+    // recheck if there exists a buffer to store a redirected message in, e.g. because a later message created it
+    for (const RawMessage* rawMsg : redirectedMessages) {
+        BufferInfo bufferInfo = _bufferInfoCache.cached(rawMsg->networkId, rawMsg->target);
+        if (!bufferInfo.isValid()) {
+            // no luck -> we store them in the StatusBuffer
+            bufferInfo = _bufferInfoCache.lookup(rawMsg->networkId, BufferInfo::StatusBuffer, "");
         }
+        messages << createMessage(*rawMsg, bufferInfo);
     }
+
     _processMessages = false;
     _messageQueue.clear();
+
+    storeMessages(std::move(messages));
 }
 
-QString CoreSession::senderPrefixes(const QString& sender, const BufferInfo& bufferInfo) const
+Message CoreSession::createMessage(const RawMessage& rawMsg, const BufferInfo& bufferInfo) const
 {
-    CoreNetwork* currentNetwork = network(bufferInfo.networkId());
-    if (!currentNetwork) {
+    CoreNetwork* currentNetwork = network(rawMsg.networkId);
+    IrcUser* sender = currentNetwork ? currentNetwork->ircUser(nickFromMask(rawMsg.sender)) : nullptr;
+
+    return Message(rawMsg.timestamp,
+                   bufferInfo,
+                   rawMsg.type,
+                   rawMsg.text,
+                   rawMsg.sender,
+                   senderPrefixes(currentNetwork, sender, bufferInfo),
+                   sender ? sender->realName() : QString{},
+                   avatarUrl(rawMsg.sender, rawMsg.networkId),
+                   rawMsg.flags);
+}
+
+QString CoreSession::senderPrefixes(const CoreNetwork* network, IrcUser* sender, const BufferInfo& bufferInfo) const
+{
+    if (!network || !sender) {
         return {};
     }
 
@@ -482,28 +493,16 @@ QString CoreSession::senderPrefixes(const QString& sender, const BufferInfo& buf
         return {};
     }
 
-    IrcChannel* currentChannel = currentNetwork->ircChannel(bufferInfo.bufferName());
+    IrcChannel* currentChannel = network->ircChannel(bufferInfo.bufferName());
     if (!currentChannel) {
         return {};
     }
 
-    const QString modes = currentChannel->userModes(nickFromMask(sender).toLower());
-    return currentNetwork->modesToPrefixes(modes);
-}
-
-QString CoreSession::realName(const QString& sender, NetworkId networkId) const
-{
-    CoreNetwork* currentNetwork = network(networkId);
-    if (!currentNetwork) {
-        return {};
-    }
-
-    IrcUser* currentUser = currentNetwork->ircUser(nickFromMask(sender));
-    if (!currentUser) {
+    const QString modes = currentChannel->userModes(sender);
+    if (modes.isEmpty()) {
         return {};
     }
-
-    return currentUser->realName();
+    return network->modesToPrefixes(modes);
 }
 
 QString CoreSession::avatarUrl(const QString& sender, NetworkId networkId) const
@@ -618,7 +617,7 @@ void CoreSession::createNetwork(const NetworkInfo& info_, const QStringList& per
                 qWarning() << QString("Invalid persistent channel declaration: %1").arg(channel);
                 continue;
             }
-            Core::bufferInfo(user(), info.networkId, BufferInfo::ChannelBuffer, rx.cap(1), true);
+            _bufferInfoCache.lookup(info.networkId, BufferInfo::ChannelBuffer, rx.cap(1));
             Core::setChannelPersistent(user(), info.networkId, rx.cap(1), true);
             if (!rx.cap(2).isEmpty())
                 Core::setPersistentChannelKey(user(), info.networkId, rx.cap(1), rx.cap(2));
@@ -665,15 +664,11 @@ void CoreSession::destroyNetwork(NetworkId id)
     Network* net = _networks.take(id);
     if (net && Core::removeNetwork(user(), id)) {
         // make sure that all unprocessed RawMessages from this network are removed
-        QList<RawMessage>::iterator messageIter = _messageQueue.begin();
-        while (messageIter != _messageQueue.end()) {
-            if (messageIter->networkId == id) {
-                messageIter = _messageQueue.erase(messageIter);
-            }
-            else {
-                ++messageIter;
-            }
-        }
+        _bufferInfoCache.evictNetwork(id);
+        _messageQueue.erase(std::remove_if(_messageQueue.begin(),
+                                           _messageQueue.end(),
+                                           [id](const RawMessage& msg) { return msg.networkId == id; }),
+                            _messageQueue.end());
         // remove buffers from syncer
         for (BufferId bufferId : Core::requestBufferIdsForNetwork(user(), id)) {
             _bufferSyncer->removeBuffer(bufferId);
@@ -685,7 +680,7 @@ void CoreSession::destroyNetwork(NetworkId id)
 
 void CoreSession::renameBuffer(const NetworkId& networkId, const QString& newName, const QString& oldName)
 {
-    BufferInfo bufferInfo = Core::bufferInfo(user(), networkId, BufferInfo::QueryBuffer, oldName, false);
+    BufferInfo bufferInfo = _bufferInfoCache.lookup(networkId, BufferInfo::QueryBuffer, oldName, false);
     if (bufferInfo.isValid()) {
         _bufferSyncer->renameBuffer(bufferInfo.bufferId(), newName);
     }
@@ -29,6 +29,7 @@
 #include <QVariant>
 
 #include "backgroundtaskhandler.h"
+#include "bufferinfocache.h"
 #include "corealiasmanager.h"
 #include "corehighlightrulemanager.h"
 #include "coreignorelistmanager.h"
@@ -54,6 +55,7 @@ class EventManager;
 class EventStringifier;
 class InternalPeer;
 class IrcParser;
+class IrcUser;
 class MessageEvent;
 class RemotePeer;
 class SignalProxy;
@@ -66,6 +68,7 @@ class CoreSession : public QObject
 
 public:
     CoreSession(UserId, bool restoreState, bool strictIdentEnabled, QObject* parent = nullptr);
+    ~CoreSession() override;
 
     std::vector<BufferInfo> buffers() const;
     inline UserId user() const { return _user; }
@@ -219,6 +222,15 @@ private slots:
 private:
     void processMessages();
 
+    /**
+     * Stores the given messages and emits displayMsg() for them once they have been assigned ids.
+     *
+     * If the core has a MessageWriter, the messages are handed over to it and displayed once the
+     * MessagesStoredEvent arrives; otherwise they are stored synchronously.
+     */
+    void storeMessages(MessageList messages);
+    void displayMessages(const MessageList& messages);
+
     void loadSettings();
 
     /// Hook for converting events to the old displayMsg() handlers
@@ -254,19 +266,23 @@ private:
     IrcParser* _ircParser;
 
     /**
-     * This method obtains the prefixes of the message's sender within a channel, by looking up their channelmodes, and
-     * processing them to prefixes based on the network's settings.
-     * @param sender The hostmask of the sender
-     * @param bufferInfo The BufferInfo object of the buffer
+     * Creates the Message to be stored and sent to clients for a RawMessage.
+     *
+     * The sender is looked up only once for all the sender-related fields, so that as few temporary strings as possible
+     * are allocated on this hot path.
+     * @param rawMsg The message as received from the network
+     * @param bufferInfo The BufferInfo object of the buffer the message goes to
      */
-    QString senderPrefixes(const QString& sender, const BufferInfo& bufferInfo) const;
+    Message createMessage(const RawMessage& rawMsg, const BufferInfo& bufferInfo) const;
 
     /**
-     * This method obtains the realname of the message's sender.
-     * @param sender The hostmask of the sender
-     * @param networkId The network the user is on
+     * This method obtains the prefixes of the message's sender within a channel, by looking up their channelmodes, and
+     * processing them to prefixes based on the network's settings.
+     * @param network The network the message was received on
+     * @param sender The IrcUser object of the sender, may be null
+     * @param bufferInfo The BufferInfo object of the buffer
      */
-    QString realName(const QString& sender, NetworkId networkId) const;
+    QString senderPrefixes(const CoreNetwork* network, IrcUser* sender, const BufferInfo& bufferInfo) const;
 
     /**
      * This method obtains the avatar of the message's sender.
@@ -274,7 +290,8 @@ private:
      * @param networkId The network the user is on
      */
     QString avatarUrl(const QString& sender, NetworkId networkId) const;
-    QList<RawMessage> _messageQueue;
+    std::vector<RawMessage> _messageQueue;
+    BufferInfoCache _bufferInfoCache;
     bool _processMessages;
     CoreIgnoreListManager _ignoreListManager;
     CoreHighlightRuleManager _highlightRuleManager;
@@ -20,13 +20,17 @@
 
 #include "coretransfer.h"
 
-#include <QCoreApplication>
 #include <QTcpSocket>
 #include <QtEndian>
 
 #include "util.h"
 
-const qint64 chunkSize = 16 * 1024;
+// Size of the data blocks relayed to the client
+const qint64 relayChunkSize = 256 * 1024;
+// Maximum amount of data buffered for the DCC socket; beyond that, TCP flow control throttles the sender
+const qint64 maxSocketBufferSize = 1024 * 1024;
+// Stop relaying while more than this is waiting to be sent to the client
+const qint64 maxPendingBytes = 1024 * 1024;
 
 CoreTransfer::CoreTransfer(Direction direction,
                            const QString& nick,
@@ -38,7 +42,6 @@ CoreTransfer::CoreTransfer(Direction direction,
     : Transfer(direction, nick, fileName, address, port, fileSize, parent)
     , _socket(nullptr)
     , _pos(0)
-    , _reading(false)
 {}
 
 quint64 CoreTransfer::transferred() const
@@ -55,11 +58,15 @@ void CoreTransfer::cleanUp()
     }
 
     _buffer.clear();
-    _reading = false;
 }
 
 void CoreTransfer::onSocketDisconnected()
 {
+    // Senders may close the connection right after the last byte, while data can still be waiting in the socket's
+    // buffer because the client was busy. Relay all of it before deciding whether the transfer is complete.
+    if (status() == Status::Transferring)
+        relayAvailableData(true);
+
     if (status() == Status::Connecting || status() == Status::Transferring) {
         setError(tr("Socket closed while still transferring!"));
     }
@@ -84,6 +91,9 @@ void CoreTransfer::requestAccepted(PeerPtr peer)
     _peer = peer;
     setStatus(Status::Pending);
 
+    // Continue relaying once the client has caught up (see onDataReceived())
+    connect(peer, &Peer::bytesWritten, this, &CoreTransfer::onDataReceived);
+
     emit accepted(peer);
 
     // FIXME temporary until we have queueing
@@ -119,6 +129,7 @@ void CoreTransfer::setupConnectionForReceive()
     setStatus(Status::Connecting);
 
     _socket = new QTcpSocket(this);
+    _socket->setReadBufferSize(maxSocketBufferSize);
     connect(_socket, &QAbstractSocket::connected, this, &CoreTransfer::startReceiving);
     connect(_socket, &QAbstractSocket::disconnected, this, &CoreTransfer::onSocketDisconnected);
     connect(_socket, selectOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error), this, &CoreTransfer::onSocketError);
@@ -134,26 +145,41 @@ void CoreTransfer::startReceiving()
 
 void CoreTransfer::onDataReceived()
 {
-    if (_reading)  // since we're spinning the event loop, we may get another readyRead() and thus reentrancy
+    relayAvailableData(false);
+}
+
+void CoreTransfer::relayAvailableData(bool ignorePendingLimit)
+{
+    if (!_socket || status() != Status::Transferring)
         return;
-    _reading = true;
 
-    while (_socket->bytesAvailable()) {
-        QByteArray data = _socket->read(chunkSize);
+    // safeguard against a disconnecting quasselclient
+    if (!_peer) {
+        setError(tr("DCC Receive: Quassel Client disconnected during transfer!"));
+        return;
+    }
+
+    // Only read as much as the client connection can take. Whatever is left stays in the socket's (bounded)
+    // read buffer, so a fast sender can't make us buffer the whole file in memory; we'll be called again
+    // once the client has caught up.
+    quint64 oldPos = _pos;
+    while (_socket->bytesAvailable() > 0 && (ignorePendingLimit || _peer->bytesToWrite() <= maxPendingBytes)) {
+        QByteArray data = _socket->read(relayChunkSize - _buffer.size());
         _pos += data.size();
-        emit transferredChanged(transferred());
         if (!relayData(data, true))
             return;
-
-        QCoreApplication::processEvents();  // don't block the rest of the core/client communication
-        if (!_socket)                       // just in case something happened during spinning the event loop that killed our socket
-            return;
     }
+    if (_pos == oldPos)
+        return;
+
+    emit transferredChanged(transferred());
 
-    // Send ack to sender. The DCC protocol only specifies 32 bit values, but modern clients (i.e. those who can send files
-    // larger than 4 GB) will ignore this anyway...
-    quint32 ack = qToBigEndian((quint32)_pos);  // qDebug() << Q_FUNC_INFO << _pos;
-    _socket->write((char*)&ack, 4);
+    // Send ack to sender, once for everything read above. The DCC protocol only specifies 32 bit values, but modern clients
+    // (i.e. those who can send files larger than 4 GB) will ignore this anyway...
+    if (_socket->state() == QAbstractSocket::ConnectedState) {
+        quint32 ack = qToBigEndian((quint32)_pos);  // qDebug() << Q_FUNC_INFO << _pos;
+        _socket->write((char*)&ack, 4);
+    }
 
     if (_pos > fileSize()) {
         qWarning() << "DCC Receive: Got more data than expected!";
@@ -164,8 +190,6 @@ void CoreTransfer::onDataReceived()
         if (relayData(QByteArray(), false))  // empty buffer
             setStatus(Status::Completed);
     }
-
-    _reading = false;
 }
 
 bool CoreTransfer::relayData(const QByteArray& data, bool requireChunkSize)
@@ -178,7 +202,7 @@ bool CoreTransfer::relayData(const QByteArray& data, bool requireChunkSize)
     _buffer.append(data);
 
     // we only want to send data to the client once we have reached the chunksize
-    if (_buffer.size() > 0 && (_buffer.size() >= chunkSize || !requireChunkSize)) {
+    if (_buffer.size() > 0 && (_buffer.size() >= relayChunkSize || !requireChunkSize)) {
         Peer* p = _peer.data();
         SYNC_OTHER(dataReceived, ARG(p), ARG(_buffer));
         _buffer.clear();
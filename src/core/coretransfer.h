@@ -57,6 +57,12 @@ private slots:
 
 private:
     void setupConnectionForReceive();
+    /**
+     * Reads data from the DCC socket and relays it to the client
+     *
+     * @param ignorePendingLimit If true, relay everything available, even if the client hasn't caught up yet
+     */
+    void relayAvailableData(bool ignorePendingLimit);
     bool relayData(const QByteArray& data, bool requireChunkSize);
     void cleanUp() override;
 
@@ -64,5 +70,4 @@ private:
     QTcpSocket* _socket;
     quint64 _pos;
     QByteArray _buffer;
-    bool _reading;
 };
@@ -28,6 +28,7 @@
 #include "ircevent.h"
 #include "irctags.h"
 #include "messageevent.h"
+#include "metrics.h"
 #include "networkevent.h"
 
 #ifdef HAVE_QCA2
@@ -84,6 +85,8 @@ QByteArray IrcParser::decrypt(Network* network, const QString& bufferName, const
 /* used to be handleServerMsg()                                  */
 void IrcParser::processNetworkIncoming(NetworkDataEvent* e)
 {
+    Metrics::ScopedTimer timer(Metrics::ircLineParse());
+
     auto* net = qobject_cast<CoreNetwork*>(e->network());
     if (!net) {
         qWarning() << "Received network event without valid network pointer!";
@@ -120,8 +123,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent* e)
     }
 
     if (net->capEnabled(IrcCap::SERVER_TIME) && tags.contains(IrcTags::SERVER_TIME)) {
-        QDateTime serverTime = QDateTime::fromString(tags[IrcTags::SERVER_TIME], "yyyy-MM-ddThh:mm:ss.zzzZ");
-        serverTime.setTimeSpec(Qt::UTC);
+        QDateTime serverTime = parseISODateTime(tags[IrcTags::SERVER_TIME]);
         if (serverTime.isValid()) {
             e->setTimestamp(serverTime);
         } else {
@@ -166,12 +168,9 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent* e)
     }
     else {
         // any other irc command
-        QString typeName = QLatin1String("IrcEvent") + cmd.at(0).toUpper() + cmd.mid(1).toLower();
-        type = EventManager::eventTypeByName(typeName);
-        if (type == EventManager::Invalid) {
-            type = EventManager::eventTypeByName("IrcEventUnknown");
-            Q_ASSERT(type != EventManager::Invalid);
-        }
+        type = EventManager::ircEventTypeByCommand(cmd);
+        if (type == EventManager::Invalid)
+            type = EventManager::IrcEventUnknown;
     }
 
     // Almost always, all params are server-encoded. There's a few exceptions, let's catch them here!
@@ -28,6 +28,8 @@
 
 #include "ldapauthenticator.h"
 
+#include <QMutexLocker>
+
 #include "ldapescaper.h"
 #include "network.h"
 #include "quassel.h"
@@ -43,14 +45,11 @@
 
 LdapAuthenticator::LdapAuthenticator(QObject* parent)
     : Authenticator(parent)
-    , _connection(nullptr)
 {}
 
 LdapAuthenticator::~LdapAuthenticator()
 {
-    if (_connection != nullptr) {
-        ldap_unbind_ext(_connection, nullptr, nullptr);
-    }
+    clearConnections();
 }
 
 bool LdapAuthenticator::isAvailable() const
@@ -115,7 +114,9 @@ void LdapAuthenticator::setAuthProperties(const QVariantMap& properties, const Q
 // through the default core method.
 UserId LdapAuthenticator::validateUser(const QString& username, const QString& password)
 {
-    bool result = ldapAuth(username, password);
+    LDAP* connection = acquireConnection();
+    bool result = ldapAuth(connection, username, password);
+    releaseConnection(connection);
     if (!result) {
         return {};
     }
@@ -131,9 +132,17 @@ UserId LdapAuthenticator::validateUser(const QString& username, const QString& p
     // cross-check to confirm we're using the right auth provider.
     UserId quasselId = Core::getUserId(lUsername);
     if (!quasselId.isValid()) {
-        return Core::addUser(lUsername, QString(), backendId());
+        quasselId = Core::addUser(lUsername, QString(), backendId());
+        if (quasselId.isValid()) {
+            return quasselId;
+        }
+        // A concurrent first login of the same user may have added it in the meantime
+        quasselId = Core::getUserId(lUsername);
+        if (!quasselId.isValid()) {
+            return {};
+        }
     }
-    else if (!(Core::checkAuthProvider(quasselId, backendId()))) {
+    if (!(Core::checkAuthProvider(quasselId, backendId()))) {
         return 0;
     }
     return quasselId;
@@ -142,16 +151,20 @@ UserId LdapAuthenticator::validateUser(const QString& username, const QString& p
 bool LdapAuthenticator::setup(const QVariantMap& settings, const QProcessEnvironment& environment, bool loadFromEnvironment)
 {
     setAuthProperties(settings, environment, loadFromEnvironment);
-    bool status = ldapConnect();
-    return status;
+    clearConnections();
+    LDAP* connection = ldapConnect();
+    releaseConnection(connection);
+    return connection != nullptr;
 }
 
 Authenticator::State LdapAuthenticator::init(const QVariantMap& settings, const QProcessEnvironment& environment, bool loadFromEnvironment)
 {
     setAuthProperties(settings, environment, loadFromEnvironment);
+    clearConnections();
 
-    bool status = ldapConnect();
-    if (!status) {
+    LDAP* connection = ldapConnect();
+    releaseConnection(connection);
+    if (!connection) {
         qInfo() << qPrintable(backendId()) << "authenticator cannot connect.";
         return NotAvailable;
     }
@@ -161,12 +174,9 @@ Authenticator::State LdapAuthenticator::init(const QVariantMap& settings, const
 }
 
 // Method based on abustany LDAP quassel patch.
-bool LdapAuthenticator::ldapConnect()
+LDAP* LdapAuthenticator::ldapConnect()
 {
-    if (_connection != nullptr) {
-        ldapDisconnect();
-    }
-
+    LDAP* connection = nullptr;
     int res, v = LDAP_VERSION3;
 
     QString serverURI;
@@ -175,38 +185,68 @@ bool LdapAuthenticator::ldapConnect()
     // Convert info to hostname:port.
     serverURI = _hostName + ":" + QString::number(_port);
     serverURIArray = serverURI.toLocal8Bit();
-    res = ldap_initialize(&_connection, serverURIArray);
+    res = ldap_initialize(&connection, serverURIArray);
 
     qInfo() << "LDAP: Connecting to" << serverURI;
 
     if (res != LDAP_SUCCESS) {
         qWarning() << "Could not connect to LDAP server:" << ldap_err2string(res);
-        return false;
+        return nullptr;
     }
 
-    res = ldap_set_option(_connection, LDAP_OPT_PROTOCOL_VERSION, (void*)&v);
+    res = ldap_set_option(connection, LDAP_OPT_PROTOCOL_VERSION, (void*)&v);
 
     if (res != LDAP_SUCCESS) {
         qWarning() << "Could not set LDAP protocol version to v3:" << ldap_err2string(res);
-        ldap_unbind_ext(_connection, nullptr, nullptr);
-        _connection = nullptr;
-        return false;
+        ldap_unbind_ext(connection, nullptr, nullptr);
+        return nullptr;
     }
 
-    return true;
+    return connection;
+}
+
+void LdapAuthenticator::ldapDisconnect(LDAP*& connection)
+{
+    if (connection == nullptr) {
+        return;
+    }
+
+    ldap_unbind_ext(connection, nullptr, nullptr);
+    connection = nullptr;
+}
+
+LDAP* LdapAuthenticator::acquireConnection()
+{
+    {
+        QMutexLocker locker(&_connectionMutex);
+        if (!_idleConnections.isEmpty()) {
+            return _idleConnections.takeLast();
+        }
+    }
+    // Connecting may take a while, so don't hold up the other logins meanwhile
+    return ldapConnect();
 }
 
-void LdapAuthenticator::ldapDisconnect()
+void LdapAuthenticator::releaseConnection(LDAP* connection)
 {
-    if (_connection == nullptr) {
+    if (connection == nullptr) {
         return;
     }
 
-    ldap_unbind_ext(_connection, nullptr, nullptr);
-    _connection = nullptr;
+    QMutexLocker locker(&_connectionMutex);
+    _idleConnections.append(connection);
+}
+
+void LdapAuthenticator::clearConnections()
+{
+    QMutexLocker locker(&_connectionMutex);
+    for (LDAP* connection : _idleConnections) {
+        ldapDisconnect(connection);
+    }
+    _idleConnections.clear();
 }
 
-bool LdapAuthenticator::ldapAuth(const QString& username, const QString& password)
+bool LdapAuthenticator::ldapAuth(LDAP*& connection, const QString& username, const QString& password)
 {
     if (password.isEmpty()) {
         return false;
@@ -215,8 +255,9 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
     int res;
 
     // Attempt to establish a connection.
-    if (_connection == nullptr) {
-        if (!ldapConnect()) {
+    if (connection == nullptr) {
+        connection = ldapConnect();
+        if (connection == nullptr) {
             return false;
         }
     }
@@ -232,11 +273,11 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
     cred.bv_val = (bindPassword.size() > 0 ? bindPassword.data() : nullptr);
     cred.bv_len = bindPassword.size();
 
-    res = ldap_sasl_bind_s(_connection, bindDN.size() > 0 ? bindDN.constData() : nullptr, LDAP_SASL_SIMPLE, &cred, nullptr, nullptr, nullptr);
+    res = ldap_sasl_bind_s(connection, bindDN.size() > 0 ? bindDN.constData() : nullptr, LDAP_SASL_SIMPLE, &cred, nullptr, nullptr, nullptr);
 
     if (res != LDAP_SUCCESS) {
         qWarning() << "Refusing connection from" << username << "(LDAP bind failed:" << ldap_err2string(res) << ")";
-        ldapDisconnect();
+        ldapDisconnect(connection);
         return false;
     }
 
@@ -244,7 +285,7 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
 
     const QByteArray ldapQuery = "(&(" + uidAttribute + '=' + LdapEscaper::escapeQuery(username).toLatin1() + ")" + _filter.toLocal8Bit() + ")";
 
-    res = ldap_search_ext_s(_connection,
+    res = ldap_search_ext_s(connection,
                             baseDN.constData(),
                             LDAP_SCOPE_SUBTREE,
                             ldapQuery.constData(),
@@ -261,13 +302,13 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
         return false;
     }
 
-    if (ldap_count_entries(_connection, msg) > 1) {
+    if (ldap_count_entries(connection, msg) > 1) {
         qWarning() << "Refusing connection from" << username << "(LDAP search returned more than one result)";
         ldap_msgfree(msg);
         return false;
     }
 
-    entry = ldap_first_entry(_connection, msg);
+    entry = ldap_first_entry(connection, msg);
 
     if (entry == nullptr) {
         qWarning() << "Refusing connection from" << username << "(LDAP search returned no results)";
@@ -279,9 +320,9 @@ bool LdapAuthenticator::ldapAuth(const QString& username, const QString& passwor
     cred.bv_val = passwordArray.data();
     cred.bv_len = password.size();
 
-    char* userDN = ldap_get_dn(_connection, entry);
+    char* userDN = ldap_get_dn(connection, entry);
 
-    res = ldap_sasl_bind_s(_connection, userDN, LDAP_SASL_SIMPLE, &cred, nullptr, nullptr, nullptr);
+    res = ldap_sasl_bind_s(connection, userDN, LDAP_SASL_SIMPLE, &cred, nullptr, nullptr, nullptr);
 
     if (res != LDAP_SUCCESS) {
         qWarning() << "Refusing connection from" << username << "(LDAP authentication failed)";
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <QList>
+#include <QMutex>
+
 #include "authenticator.h"
 #include "core.h"
 
@@ -68,9 +71,14 @@ public slots:
 
 protected:
     void setAuthProperties(const QVariantMap& properties, const QProcessEnvironment& environment, bool loadFromEnvironment);
-    bool ldapConnect();
-    void ldapDisconnect();
-    bool ldapAuth(const QString& username, const QString& password);
+    LDAP* ldapConnect();
+    void ldapDisconnect(LDAP*& connection);
+    bool ldapAuth(LDAP*& connection, const QString& username, const QString& password);
+
+    // Connections are pooled, so concurrent logins on the auth worker threads each bind on a connection of their own.
+    LDAP* acquireConnection();
+    void releaseConnection(LDAP* connection);
+    void clearConnections();
 
     // Protected methods for retrieving info about the LDAP connection.
     QString hostName() const { return _hostName; }
@@ -87,6 +95,7 @@ private:
     QString _bindPassword;
     QString _uidAttribute;
 
-    // The actual connection object.
-    LDAP* _connection{nullptr};
+    // Connections not currently used by any login
+    QList<LDAP*> _idleConnections;
+    QMutex _connectionMutex;
 };
@@ -0,0 +1,171 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "messagewriter.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutexLocker>
+
+#include "metrics.h"
+#include "metricsserver.h"
+#include "storage.h"
+
+const int MessagesStoredEvent::EventId = QEvent::registerEventType();
+
+MessageWriter::MessageWriter(Storage* storage, MetricsServer* metricsServer, int commitInterval, int maxBatchSize, QObject* parent)
+    : QThread(parent)
+    , _storage(storage)
+    , _metricsServer(metricsServer)
+    , _commitInterval(commitInterval)
+    , _maxBatchSize(qMax(maxBatchSize, 1))
+{
+    setObjectName("MessageWriter");
+}
+
+MessageWriter::~MessageWriter()
+{
+    stop();
+}
+
+void MessageWriter::attach(QObject* receiver)
+{
+    QMutexLocker locker(&_mutex);
+    _receivers.insert(receiver);
+}
+
+void MessageWriter::detach(QObject* receiver)
+{
+    QMutexLocker locker(&_mutex);
+    _receivers.remove(receiver);
+}
+
+void MessageWriter::enqueue(QObject* receiver, MessageList messages)
+{
+    if (messages.isEmpty())
+        return;
+
+    QMutexLocker locker(&_mutex);
+    if (_queue.isEmpty())
+        _oldestQueued.start();
+
+    _queuedMessages += messages.count();
+    _queue.append(Batch{receiver, std::move(messages)});
+
+    if (_metricsServer) {
+        _metricsServer->messageWriterQueue(_queuedMessages);
+    }
+
+    // Wake the writer when the first batch arrives so it starts the commit interval, and when the
+    // queue is full so it doesn't wait for the interval to elapse
+    if (_queue.count() == 1 || _queuedMessages >= _maxBatchSize)
+        _wakeUp.wakeAll();
+}
+
+void MessageWriter::stop()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _stopping = true;
+        _wakeUp.wakeAll();
+    }
+    wait();
+}
+
+void MessageWriter::run()
+{
+    QMutexLocker locker(&_mutex);
+    while (true) {
+        while (_queue.isEmpty() && !_stopping)
+            _wakeUp.wait(&_mutex);
+
+        if (_queue.isEmpty())
+            break;  // Stopping, and everything has been committed
+
+        // Give other sessions the chance to join this commit, unless the queue is full already
+        while (!_stopping && _queuedMessages < _maxBatchSize) {
+            qint64 remaining = _commitInterval - _oldestQueued.elapsed();
+            if (remaining <= 0)
+                break;
+            _wakeUp.wait(&_mutex, static_cast<unsigned long>(remaining));
+        }
+
+        QList<Batch> batches;
+        batches.swap(_queue);
+        _queuedMessages = 0;
+        if (_metricsServer) {
+            _metricsServer->messageWriterQueue(0);
+        }
+
+        locker.unlock();
+        commit(batches);
+        locker.relock();
+    }
+}
+
+void MessageWriter::commit(QList<Batch>& batches)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int messageCount = 0;
+    if (batches.count() == 1) {
+        Batch& batch = batches.first();
+        batch.success = _storage->logMessages(batch.messages);
+        messageCount = batch.messages.count();
+    }
+    else {
+        MessageList messages;
+        for (const Batch& batch : batches) {
+            messages.append(batch.messages);
+        }
+        messageCount = messages.count();
+
+        if (_storage->logMessages(messages)) {
+            // Hand the assigned ids back to the messages of each batch
+            int i = 0;
+            for (Batch& batch : batches) {
+                for (Message& msg : batch.messages) {
+                    msg.setMsgId(messages.at(i++).msgId());
+                }
+            }
+        }
+        else {
+            // The group commit has been rolled back as a whole; retry each batch on its own, so a
+            // single offending message doesn't cost other sessions their messages
+            qWarning() << "MessageWriter: group commit of" << messageCount << "messages failed, retrying per session";
+            for (Batch& batch : batches) {
+                batch.success = _storage->logMessages(batch.messages);
+            }
+        }
+    }
+
+    Metrics::storageCommit().observe(timer.nsecsElapsed());
+    if (_metricsServer) {
+        _metricsServer->messageWriterCommit(messageCount);
+    }
+
+    QMutexLocker locker(&_mutex);
+    for (Batch& batch : batches) {
+        if (_receivers.contains(batch.receiver)) {
+            QCoreApplication::postEvent(batch.receiver, new MessagesStoredEvent(std::move(batch.messages), batch.success));
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <utility>
+
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "message.h"
+
+class MetricsServer;
+class Storage;
+
+/**
+ * Event carrying a batch of messages back to the session that queued them.
+ *
+ * Posted by the MessageWriter once the messages have been committed to the storage backend and
+ * have been assigned their MsgIds.
+ */
+class MessagesStoredEvent : public QEvent
+{
+public:
+    static const int EventId;
+
+    MessagesStoredEvent(MessageList messages, bool success)
+        : QEvent(QEvent::Type(EventId))
+        , messages(std::move(messages))
+        , success(success)
+    {}
+
+    MessageList messages;
+    bool success;
+};
+
+/**
+ * Write-behind stage for message storage.
+ *
+ * Messages queued by all sessions are coalesced into a single transaction, which is committed
+ * either once the oldest queued message has waited for the configured commit interval, or once the
+ * configured number of messages has been queued, whichever happens first. The commit happens on a
+ * dedicated thread, so IRC processing in the session threads is no longer blocked by the storage
+ * backend. Once a batch has been stored, a MessagesStoredEvent is posted to the QObject that queued
+ * it, carrying the messages with their newly assigned MsgIds.
+ */
+class MessageWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param storage        The storage backend to write to
+     * @param metricsServer  Metrics server to report queue depth and committed messages to, may be null
+     * @param commitInterval Maximum time in milliseconds a message may wait before being committed
+     * @param maxBatchSize   Number of queued messages that triggers an immediate commit
+     * @param parent         Parent object
+     */
+    MessageWriter(Storage* storage, MetricsServer* metricsServer, int commitInterval, int maxBatchSize, QObject* parent = nullptr);
+    ~MessageWriter() override;
+
+    /**
+     * Registers a receiver for MessagesStoredEvents.
+     *
+     * @note This method is threadsafe.
+     */
+    void attach(QObject* receiver);
+
+    /**
+     * Unregisters a receiver.
+     *
+     * Messages already queued by the receiver will still be stored, but no further events will be
+     * posted to it. Must be called before the receiver is destroyed.
+     *
+     * @note This method is threadsafe.
+     */
+    void detach(QObject* receiver);
+
+    /**
+     * Queues messages for storage.
+     *
+     * @note This method is threadsafe.
+     *
+     * @param receiver The object to post the MessagesStoredEvent to
+     * @param messages The messages to store, in order
+     */
+    void enqueue(QObject* receiver, MessageList messages);
+
+    /**
+     * Commits all queued messages and stops the writer thread.
+     */
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    struct Batch
+    {
+        QObject* receiver;
+        MessageList messages;
+        bool success{true};
+    };
+
+    void commit(QList<Batch>& batches);
+
+    Storage* _storage;
+    MetricsServer* _metricsServer;
+    int _commitInterval;
+    int _maxBatchSize;
+
+    QMutex _mutex;
+    QWaitCondition _wakeUp;
+    QList<Batch> _queue;  ///< Batches waiting for the next group commit
+    int _queuedMessages{0};
+    QElapsedTimer _oldestQueued;  ///< Time since the oldest batch in the queue was added
+    QSet<QObject*> _receivers;
+    bool _stopping{false};
+};
@@ -25,11 +25,24 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QHostAddress>
+#include <QList>
+#include <QMutexLocker>
+#include <QPair>
 #include <QStringList>
 #include <QTcpSocket>
 
 #include "core.h"
 #include "corenetwork.h"
+#include "metrics.h"
+
+namespace {
+
+QString formatSeconds(int64_t nsecs)
+{
+    return QString::number(nsecs / 1e9, 'g', 10);
+}
+
+}  // namespace
 
 MetricsServer::MetricsServer(QObject* parent)
     : QObject(parent)
@@ -38,6 +51,11 @@ MetricsServer::MetricsServer(QObject* parent)
     connect(&_v6server, &QTcpServer::newConnection, this, &MetricsServer::incomingConnection);
 }
 
+MetricsServer::~MetricsServer()
+{
+    qDeleteAll(_userMetrics);
+}
+
 bool MetricsServer::startListening()
 {
     bool success = false;
@@ -196,14 +214,25 @@ void MetricsServer::respond()
             );
         }
         int64_t timestamp = QDateTime::currentMSecsSinceEpoch();
-        for (const auto& key : _sessions.keys()) {
-            const QString& name = _sessions[key];
+        QList<QPair<QString, const UserMetrics*>> users;
+        {
+            QMutexLocker locker(&_mutex);
+            for (auto it = _sessions.cbegin(); it != _sessions.cend(); ++it) {
+                const UserMetrics* metrics = _userMetrics.value(it.key());
+                if (metrics) {
+                    users.append(qMakePair(it.value(), metrics));
+                }
+            }
+        }
+        for (const auto& user : users) {
+            const QString& name = user.first;
+            const UserMetrics& metrics = *user.second;
             socket->write("# HELP quassel_network_bytes_received Number of currently open connections from quassel clients\n");
             socket->write("# TYPE quassel_client_sessions gauge\n");
             socket->write(
                 QString("quassel_client_sessions{user=\"%1\"} %2 %3\n")
                     .arg(name)
-                    .arg(_clientSessions.value(key, 0))
+                    .arg(metrics.clientSessions.load())
                     .arg(timestamp)
                     .toUtf8()
             );
@@ -212,7 +241,7 @@ void MetricsServer::respond()
             socket->write(
                 QString("quassel_network_sessions{user=\"%1\"} %2 %3\n")
                     .arg(name)
-                    .arg(_networkSessions.value(key, 0))
+                    .arg(metrics.networkSessions.load())
                     .arg(timestamp)
                     .toUtf8()
             );
@@ -221,7 +250,7 @@ void MetricsServer::respond()
             socket->write(
                 QString("quassel_network_bytes_sent{user=\"%1\"} %2 %3\n")
                     .arg(name)
-                    .arg(_networkDataTransmit.value(key, 0))
+                    .arg(metrics.networkDataTransmit.load())
                     .arg(timestamp)
                     .toUtf8()
             );
@@ -230,7 +259,23 @@ void MetricsServer::respond()
             socket->write(
                 QString("quassel_network_bytes_received{user=\"%1\"} %2 %3\n")
                     .arg(name)
-                    .arg(_networkDataReceive.value(key, 0))
+                    .arg(metrics.networkDataReceive.load())
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write("# HELP quassel_network_lines_per_read Number of IRC lines handled per socket read\n");
+            socket->write("# TYPE quassel_network_lines_per_read summary\n");
+            socket->write(
+                QString("quassel_network_lines_per_read_sum{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(metrics.networkLinesReceive.load())
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write(
+                QString("quassel_network_lines_per_read_count{user=\"%1\"} %2 %3\n")
+                    .arg(name)
+                    .arg(metrics.networkReads.load())
                     .arg(timestamp)
                     .toUtf8()
             );
@@ -239,23 +284,88 @@ void MetricsServer::respond()
             socket->write(
                 QString("quassel_message_queue{user=\"%1\"} %2 %3\n")
                     .arg(name)
-                    .arg(_messageQueue.value(key, 0))
+                    .arg(metrics.messageQueue.load())
                     .arg(timestamp)
                     .toUtf8()
             );
+            const uint64_t successfulLogins = metrics.successfulLogins.load();
             socket->write("# HELP quassel_login_attempts The number of times the user has attempted to log in\n");
             socket->write("# TYPE quassel_login_attempts counter\n");
             socket->write(
                 QString("quassel_login_attempts{user=\"%1\",successful=\"false\"} %2 %3\n")
                     .arg(name)
-                    .arg(_loginAttempts.value(key, 0) - _successfulLogins.value(key, 0))
+                    .arg(metrics.loginAttempts.load() - successfulLogins)
                     .arg(timestamp)
                     .toUtf8()
             );
             socket->write(
                 QString("quassel_login_attempts{user=\"%1\",successful=\"true\"} %2 %3\n")
                     .arg(name)
-                    .arg(_successfulLogins.value(key, 0))
+                    .arg(successfulLogins)
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+        }
+        socket->write("# HELP quassel_storage_queue_depth Number of messages waiting for the next group commit\n");
+        socket->write("# TYPE quassel_storage_queue_depth gauge\n");
+        socket->write(
+            QString("quassel_storage_queue_depth %1 %2\n")
+                .arg(_messageWriterQueue.load())
+                .arg(timestamp)
+                .toUtf8()
+        );
+        socket->write("# HELP quassel_storage_committed_messages Number of messages stored through group commits\n");
+        socket->write("# TYPE quassel_storage_committed_messages counter\n");
+        socket->write(
+            QString("quassel_storage_committed_messages %1 %2\n")
+                .arg(_messageWriterMessages.load())
+                .arg(timestamp)
+                .toUtf8()
+        );
+        for (const Metrics::Counter* counter : Metrics::counters()) {
+            socket->write(QString("# HELP %1 %2\n").arg(counter->name(), counter->help()).toUtf8());
+            socket->write(QString("# TYPE %1 counter\n").arg(counter->name()).toUtf8());
+            socket->write(
+                QString("%1 %2 %3\n")
+                    .arg(counter->name())
+                    .arg(counter->value())
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+        }
+        const auto& bounds = Metrics::Histogram::bucketBounds();
+        for (const Metrics::Histogram* histogram : Metrics::histograms()) {
+            const Metrics::Histogram::Snapshot snapshot = histogram->snapshot();
+            socket->write(QString("# HELP %1 %2\n").arg(histogram->name(), histogram->help()).toUtf8());
+            socket->write(QString("# TYPE %1 histogram\n").arg(histogram->name()).toUtf8());
+            for (int i = 0; i < Metrics::Histogram::bucketCount; i++) {
+                socket->write(
+                    QString("%1_bucket{le=\"%2\"} %3 %4\n")
+                        .arg(histogram->name())
+                        .arg(formatSeconds(bounds[i]))
+                        .arg(snapshot.buckets[i])
+                        .arg(timestamp)
+                        .toUtf8()
+                );
+            }
+            socket->write(
+                QString("%1_bucket{le=\"+Inf\"} %2 %3\n")
+                    .arg(histogram->name())
+                    .arg(snapshot.count)
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write(
+                QString("%1_sum %2 %3\n")
+                    .arg(histogram->name())
+                    .arg(formatSeconds(snapshot.sumNsecs))
+                    .arg(timestamp)
+                    .toUtf8()
+            );
+            socket->write(
+                QString("%1_count %2 %3\n")
+                    .arg(histogram->name())
+                    .arg(snapshot.count)
                     .arg(timestamp)
                     .toUtf8()
             );
@@ -311,15 +421,30 @@ void MetricsServer::respond()
     }
 }
 
+MetricsServer::UserMetrics* MetricsServer::userMetrics(UserId user)
+{
+    QMutexLocker locker(&_mutex);
+    UserMetrics*& metrics = _userMetrics[user];
+    if (!metrics) {
+        metrics = new UserMetrics;
+    }
+    return metrics;
+}
+
 void MetricsServer::addLoginAttempt(UserId user, bool successful) {
-    _loginAttempts.insert(user, _loginAttempts.value(user, 0) + 1);
+    UserMetrics* metrics = userMetrics(user);
+    metrics->loginAttempts++;
     if (successful) {
-        _successfulLogins.insert(user, _successfulLogins.value(user, 0) + 1);
+        metrics->successfulLogins++;
     }
 }
 
 void MetricsServer::addLoginAttempt(const QString& user, bool successful) {
-    UserId userId = _sessions.key(user);
+    UserId userId;
+    {
+        QMutexLocker locker(&_mutex);
+        userId = _sessions.key(user);
+    }
     if (userId.isValid()) {
         addLoginAttempt(userId, successful);
     }
@@ -327,59 +452,65 @@ void MetricsServer::addLoginAttempt(const QString& user, bool successful) {
 
 void MetricsServer::addSession(UserId user, const QString& name)
 {
+    QMutexLocker locker(&_mutex);
     _sessions.insert(user, name);
 }
 
 void MetricsServer::removeSession(UserId user)
 {
+    QMutexLocker locker(&_mutex);
     _sessions.remove(user);
 }
 
 void MetricsServer::addClient(UserId user)
 {
-    _clientSessions.insert(user, _clientSessions.value(user, 0) + 1);
+    userMetrics(user)->clientSessions++;
 }
 
 void MetricsServer::removeClient(UserId user)
 {
-    int32_t count = _clientSessions.value(user, 0) - 1;
-    if (count <= 0) {
-        _clientSessions.remove(user);
-    }
-    else {
-        _clientSessions.insert(user, count);
-    }
+    userMetrics(user)->clientSessions--;
 }
 
 void MetricsServer::addNetwork(UserId user)
 {
-    _networkSessions.insert(user, _networkSessions.value(user, 0) + 1);
+    userMetrics(user)->networkSessions++;
 }
 
 void MetricsServer::removeNetwork(UserId user)
 {
-    int32_t count = _networkSessions.value(user, 0) - 1;
-    if (count <= 0) {
-        _networkSessions.remove(user);
-    }
-    else {
-        _networkSessions.insert(user, count);
-    }
+    userMetrics(user)->networkSessions--;
+}
+
+void MetricsServer::transmitDataNetwork(UserMetrics* user, uint64_t size)
+{
+    user->networkDataTransmit.fetch_add(size, std::memory_order_relaxed);
+}
+
+void MetricsServer::receiveDataNetwork(UserMetrics* user, uint64_t size)
+{
+    user->networkDataReceive.fetch_add(size, std::memory_order_relaxed);
+}
+
+void MetricsServer::receiveLinesNetwork(UserMetrics* user, uint64_t lines)
+{
+    user->networkLinesReceive.fetch_add(lines, std::memory_order_relaxed);
+    user->networkReads.fetch_add(1, std::memory_order_relaxed);
 }
 
-void MetricsServer::transmitDataNetwork(UserId user, uint64_t size)
+void MetricsServer::messageQueue(UserMetrics* user, uint64_t size)
 {
-    _networkDataTransmit.insert(user, _networkDataTransmit.value(user, 0) + size);
+    user->messageQueue.store(size, std::memory_order_relaxed);
 }
 
-void MetricsServer::receiveDataNetwork(UserId user, uint64_t size)
+void MetricsServer::messageWriterQueue(uint64_t size)
 {
-    _networkDataReceive.insert(user, _networkDataReceive.value(user, 0) + size);
+    _messageWriterQueue = size;
 }
 
-void MetricsServer::messageQueue(UserId user, uint64_t size)
+void MetricsServer::messageWriterCommit(uint64_t messages)
 {
-    _messageQueue.insert(user, size);
+    _messageWriterMessages += messages;
 }
 
 void MetricsServer::setCertificateExpires(QDateTime expires)
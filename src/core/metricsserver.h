@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QString>
 #include <QTcpServer>
@@ -32,11 +35,45 @@ class MetricsServer : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * Counters of a single user.
+     *
+     * A user's networks and clients all live in its session thread, so apart from login attempts (main thread) every
+     * counter has a single writer and is updated with relaxed atomics, without any locking.
+     */
+    struct UserMetrics
+    {
+        std::atomic<uint64_t> loginAttempts{0};
+        std::atomic<uint64_t> successfulLogins{0};
+
+        std::atomic<int32_t> clientSessions{0};
+        std::atomic<int32_t> networkSessions{0};
+
+        std::atomic<uint64_t> networkDataTransmit{0};
+        std::atomic<uint64_t> networkDataReceive{0};
+        std::atomic<uint64_t> networkLinesReceive{0};
+        std::atomic<uint64_t> networkReads{0};
+
+        std::atomic<uint64_t> messageQueue{0};
+    };
+
     explicit MetricsServer(QObject* parent = nullptr);
+    ~MetricsServer() override;
 
     bool startListening();
     void stopListening(const QString& msg);
 
+    /**
+     * Returns the counters of the given user, creating them if needed.
+     *
+     * The returned pointer stays valid for the lifetime of the metrics server, so hot paths should look it up once
+     * and keep it around.
+     *
+     * @param user The user's ID
+     * @returns The user's counters
+     */
+    UserMetrics* userMetrics(UserId user);
+
     void addLoginAttempt(UserId user, bool successful);
     void addLoginAttempt(const QString& user, bool successful);
 
@@ -49,10 +86,14 @@ public:
     void addNetwork(UserId user);
     void removeNetwork(UserId user);
 
-    void transmitDataNetwork(UserId user, uint64_t size);
-    void receiveDataNetwork(UserId user, uint64_t size);
+    void transmitDataNetwork(UserMetrics* user, uint64_t size);
+    void receiveDataNetwork(UserMetrics* user, uint64_t size);
+    void receiveLinesNetwork(UserMetrics* user, uint64_t lines);
+
+    void messageQueue(UserMetrics* user, uint64_t size);
 
-    void messageQueue(UserId user, uint64_t size);
+    void messageWriterQueue(uint64_t size);
+    void messageWriterCommit(uint64_t messages);
 
     void setCertificateExpires(QDateTime expires);
 
@@ -63,18 +104,15 @@ private slots:
 private:
     QTcpServer _server, _v6server;
 
-    QHash<UserId, uint64_t> _loginAttempts{};
-    QHash<UserId, uint64_t> _successfulLogins{};
-
+    // Sessions are added and removed from their session threads, so the maps are guarded by _mutex.
+    // The counters themselves are atomic and never deleted before the metrics server.
+    QMutex _mutex;
     QHash<UserId, QString> _sessions{};
+    QHash<UserId, UserMetrics*> _userMetrics{};
 
-    QHash<UserId, int32_t> _clientSessions{};
-    QHash<UserId, int32_t> _networkSessions{};
-
-    QHash<UserId, uint64_t> _networkDataTransmit{};
-    QHash<UserId, uint64_t> _networkDataReceive{};
-
-    QHash<UserId, uint64_t> _messageQueue{};
+    // Updated from the message writer thread
+    std::atomic<uint64_t> _messageWriterQueue{0};
+    std::atomic<uint64_t> _messageWriterMessages{0};
 
     QDateTime _certificateExpires{};
 };
@@ -1127,8 +1127,7 @@ BufferInfo PostgreSqlStorage::bufferInfo(UserId user, const NetworkId& networkId
         return {};
     }
 
-    QSqlQuery query(db);
-    query.prepare(queryString("select_bufferByName"));
+    QSqlQuery query = cachedQuery("select_bufferByName", db);
     query.bindValue(":networkid", networkId.toInt());
     query.bindValue(":userid", user.toInt());
     query.bindValue(":buffercname", buffer.toLower());
@@ -1155,8 +1154,7 @@ BufferInfo PostgreSqlStorage::bufferInfo(UserId user, const NetworkId& networkId
         return {};
     }
 
-    QSqlQuery createQuery(db);
-    createQuery.prepare(queryString("insert_buffer"));
+    QSqlQuery createQuery = cachedQuery("insert_buffer", db);
     createQuery.bindValue(":userid", user.toInt());
     createQuery.bindValue(":networkid", networkId.toInt());
     createQuery.bindValue(":buffertype", (int)type);
@@ -1181,8 +1179,7 @@ BufferInfo PostgreSqlStorage::bufferInfo(UserId user, const NetworkId& networkId
 
 BufferInfo PostgreSqlStorage::getBufferInfo(UserId user, const BufferId& bufferId)
 {
-    QSqlQuery query(logDb());
-    query.prepare(queryString("select_buffer_by_id"));
+    QSqlQuery query = cachedQuery("select_buffer_by_id", logDb());
     query.bindValue(":userid", user.toInt());
     query.bindValue(":bufferid", bufferId.toInt());
     safeExec(query);
@@ -1388,8 +1385,7 @@ QHash<BufferId, MsgId> PostgreSqlStorage::bufferLastMsgIds(UserId user)
         return lastMsgHash;
     }
 
-    QSqlQuery query(db);
-    query.prepare(queryString("select_buffer_last_messages"));
+    QSqlQuery query = cachedQuery("select_buffer_last_messages", db);
     query.bindValue(":userid", user.toInt());
     safeExec(query);
     if (!watchQuery(query)) {
@@ -1428,8 +1424,7 @@ QHash<BufferId, MsgId> PostgreSqlStorage::bufferLastSeenMsgIds(UserId user)
         return lastSeenHash;
     }
 
-    QSqlQuery query(db);
-    query.prepare(queryString("select_buffer_lastseen_messages"));
+    QSqlQuery query = cachedQuery("select_buffer_lastseen_messages", db);
     query.bindValue(":userid", user.toInt());
     safeExec(query);
     if (!watchQuery(query)) {
@@ -1792,6 +1787,47 @@ std::vector<Message> PostgreSqlStorage::requestMsgs(UserId user, BufferId buffer
         return messagelist;
     }
 
+    if (!selectMsgs(db, bufferInfo, first, last, limit, messagelist)) {
+        db.rollback();
+        return messagelist;
+    }
+
+    db.commit();
+    return messagelist;
+}
+
+std::vector<std::vector<Message>> PostgreSqlStorage::requestMsgsBatch(UserId user, const std::vector<MsgRequest>& requests)
+{
+    std::vector<std::vector<Message>> results(requests.size());
+    if (requests.empty())
+        return results;
+
+    QSqlDatabase db = logDb();
+    if (!beginReadOnlyTransaction(db)) {
+        qWarning() << "PostgreSqlStorage::requestMsgsBatch(): cannot start read only transaction!";
+        qWarning() << " -" << qPrintable(db.lastError().text());
+        return results;
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const MsgRequest& request = requests[i];
+        BufferInfo bufferInfo = getBufferInfo(user, request.bufferId);
+        if (!bufferInfo.isValid())
+            continue;
+        if (!selectMsgs(db, bufferInfo, request.first, request.last, request.limit, results[i])) {
+            // The transaction is aborted at this point, so don't bother with the remaining buffers
+            db.rollback();
+            return results;
+        }
+    }
+
+    db.commit();
+    return results;
+}
+
+bool PostgreSqlStorage::selectMsgs(
+    QSqlDatabase& db, const BufferInfo& bufferInfo, MsgId first, MsgId last, int limit, std::vector<Message>& messagelist)
+{
     QString queryName;
     QVariantList params;
     if (last == -1 && first == -1) {
@@ -1806,7 +1842,7 @@ std::vector<Message> PostgreSqlStorage::requestMsgs(UserId user, BufferId buffer
         params << first.toQint64();
         params << last.toQint64();
     }
-    params << bufferId.toInt();
+    params << bufferInfo.bufferId().toInt();
     if (limit != -1)
         params << limit;
     else
@@ -1816,8 +1852,7 @@ std::vector<Message> PostgreSqlStorage::requestMsgs(UserId user, BufferId buffer
 
     if (!watchQuery(query)) {
         qDebug() << "select_messages failed";
-        db.rollback();
-        return messagelist;
+        return false;
     }
 
     QDateTime timestamp;
@@ -1838,9 +1873,7 @@ std::vector<Message> PostgreSqlStorage::requestMsgs(UserId user, BufferId buffer
         msg.setMsgId(query.value(0).toLongLong());
         messagelist.push_back(std::move(msg));
     }
-
-    db.commit();
-    return messagelist;
+    return true;
 }
 
 std::vector<Message> PostgreSqlStorage::requestMsgsFiltered(
@@ -1991,12 +2024,6 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgs(UserId user, MsgId first,
 {
     std::vector<Message> messagelist;
 
-    // requestBuffers uses it's own transaction.
-    QHash<BufferId, BufferInfo> bufferInfoHash;
-    foreach (BufferInfo bufferInfo, requestBuffers(user)) {
-        bufferInfoHash[bufferInfo.bufferId()] = bufferInfo;
-    }
-
     QSqlDatabase db = logDb();
     if (!beginReadOnlyTransaction(db)) {
         qWarning() << "PostgreSqlStorage::requestAllMsgs(): cannot start read only transaction!";
@@ -2014,20 +2041,32 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgs(UserId user, MsgId first,
     }
     query.bindValue(":userid", user.toInt());
     query.bindValue(":firstmsg", first.toQint64());
+    // A NULL limit is the same as LIMIT ALL
+    query.bindValue(":limit", limit < 0 ? QVariant(QVariant::Int) : QVariant(limit));
     safeExec(query);
     if (!watchQuery(query)) {
         db.rollback();
         return messagelist;
     }
 
+    // The buffer is part of every row, but all messages of a buffer share one BufferInfo
+    QHash<BufferId, BufferInfo> bufferInfoHash;
     QDateTime timestamp;
-    for (int i = 0; i < limit && query.next(); i++) {
+    while (query.next()) {
+        BufferId bufferId = query.value(1).toInt();
+        if (!bufferInfoHash.contains(bufferId)) {
+            bufferInfoHash[bufferId] = BufferInfo(bufferId,
+                                                  query.value(10).toInt(),
+                                                  (BufferInfo::Type)query.value(11).toInt(),
+                                                  query.value(12).toInt(),
+                                                  query.value(13).toString());
+        }
         // PostgreSQL returns date/time in ISO 8601 format, no 64-bit handling needed
         // See https://www.postgresql.org/docs/current/static/datatype-datetime.html#DATATYPE-DATETIME-OUTPUT
         timestamp = query.value(2).toDateTime();
         timestamp.setTimeSpec(Qt::UTC);
         Message msg(timestamp,
-                    bufferInfoHash[query.value(1).toInt()],
+                    bufferInfoHash[bufferId],
                     (Message::Type)query.value(3).toInt(),
                     query.value(9).toString(),
                     query.value(5).toString(),
@@ -2048,12 +2087,6 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgsFiltered(
 {
     std::vector<Message> messagelist;
 
-    // requestBuffers uses it's own transaction.
-    QHash<BufferId, BufferInfo> bufferInfoHash;
-    foreach (BufferInfo bufferInfo, requestBuffers(user)) {
-        bufferInfoHash[bufferInfo.bufferId()] = bufferInfo;
-    }
-
     QSqlDatabase db = logDb();
     if (!beginReadOnlyTransaction(db)) {
         qWarning() << "PostgreSqlStorage::requestAllMsgs(): cannot start read only transaction!";
@@ -2071,6 +2104,8 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgsFiltered(
     }
     query.bindValue(":userid", user.toInt());
     query.bindValue(":firstmsg", first.toQint64());
+    // A NULL limit is the same as LIMIT ALL
+    query.bindValue(":limit", limit < 0 ? QVariant(QVariant::Int) : QVariant(limit));
 
     int typeRaw = type;
     query.bindValue(":type", typeRaw);
@@ -2084,14 +2119,24 @@ std::vector<Message> PostgreSqlStorage::requestAllMsgsFiltered(
         return messagelist;
     }
 
+    // The buffer is part of every row, but all messages of a buffer share one BufferInfo
+    QHash<BufferId, BufferInfo> bufferInfoHash;
     QDateTime timestamp;
-    for (int i = 0; i < limit && query.next(); i++) {
+    while (query.next()) {
+        BufferId bufferId = query.value(1).toInt();
+        if (!bufferInfoHash.contains(bufferId)) {
+            bufferInfoHash[bufferId] = BufferInfo(bufferId,
+                                                  query.value(10).toInt(),
+                                                  (BufferInfo::Type)query.value(11).toInt(),
+                                                  query.value(12).toInt(),
+                                                  query.value(13).toString());
+        }
         // PostgreSQL returns date/time in ISO 8601 format, no 64-bit handling needed
         // See https://www.postgresql.org/docs/current/static/datatype-datetime.html#DATATYPE-DATETIME-OUTPUT
         timestamp = query.value(2).toDateTime();
         timestamp.setTimeSpec(Qt::UTC);
         Message msg(timestamp,
-                    bufferInfoHash[query.value(1).toInt()],
+                    bufferInfoHash[bufferId],
                     (Message::Type)query.value(3).toInt(),
                     query.value(9).toString(),
                     query.value(5).toString(),
@@ -2170,6 +2215,21 @@ QSqlQuery PostgreSqlStorage::prepareAndExecuteQuery(const QString& queryname, co
     // we just EXECUTE and catch the error
     QSqlQuery query;
 
+    // Once a statement is known to be prepared on this connection, there's no need to guard the EXECUTE with a
+    // savepoint anymore: any error is a genuine one and is propagated to the caller as is
+    StatementCache* cache = statementCache(db);
+    if (cache && cache->serverPrepared.contains(queryname)) {
+        if (paramstring.isNull()) {
+            query = db.exec(QString("EXECUTE quassel_%1").arg(queryname));
+        }
+        else {
+            query = db.exec(QString("EXECUTE quassel_%1 (%2)").arg(queryname).arg(paramstring));
+        }
+        if (db.isOpen())
+            return query;
+        // The connection was lost; fall through to the recovery path below
+    }
+
     db.exec("SAVEPOINT quassel_prepare_query");
     if (paramstring.isNull()) {
         query = db.exec(QString("EXECUTE quassel_%1").arg(queryname));
@@ -2222,6 +2282,11 @@ QSqlQuery PostgreSqlStorage::prepareAndExecuteQuery(const QString& queryname, co
         // only release the SAVEPOINT
         db.exec("RELEASE SAVEPOINT quassel_prepare_query");
     }
+
+    // Either way, the statement exists on this connection now
+    cache = statementCache(db);
+    if (cache)
+        cache->serverPrepared.insert(queryname);
     return query;
 }
 
@@ -2266,6 +2331,9 @@ QSqlQuery PostgreSqlStorage::executePreparedQuery(const QString& queryname, cons
 void PostgreSqlStorage::deallocateQuery(const QString& queryname, const QSqlDatabase& db)
 {
     db.exec(QString("DEALLOCATE quassel_%1").arg(queryname));
+    StatementCache* cache = statementCache(db);
+    if (cache)
+        cache->serverPrepared.remove(queryname);
 }
 
 void PostgreSqlStorage::safeExec(QSqlQuery& query)
@@ -109,6 +109,7 @@ public:
     bool logMessage(Message& msg) override;
     bool logMessages(MessageList& msgs) override;
     std::vector<Message> requestMsgs(UserId user, BufferId bufferId, MsgId first = -1, MsgId last = -1, int limit = -1) override;
+    std::vector<std::vector<Message>> requestMsgsBatch(UserId user, const std::vector<MsgRequest>& requests) override;
     std::vector<Message> requestMsgsFiltered(UserId user,
                                              BufferId bufferId,
                                              MsgId first = -1,
@@ -178,6 +179,8 @@ protected:
 private:
     void bindNetworkInfo(QSqlQuery& query, const NetworkInfo& info);
     void bindServerInfo(QSqlQuery& query, const Network::Server& server);
+    // Helper for requestMsgs() and requestMsgsBatch(); expects an open transaction
+    bool selectMsgs(QSqlDatabase& db, const BufferInfo& bufferInfo, MsgId first, MsgId last, int limit, std::vector<Message>& messagelist);
     QSqlQuery prepareAndExecuteQuery(const QString& queryname, const QString& paramstring, QSqlDatabase& db);
     QSqlQuery prepareAndExecuteQuery(const QString& queryname, QSqlDatabase& db)
     {
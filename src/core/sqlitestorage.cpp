@@ -23,6 +23,7 @@
 #include <QByteArray>
 #include <QDataStream>
 #include <QLatin1String>
+#include <QTimer>
 #include <QVariant>
 
 #include "network.h"
@@ -30,10 +31,65 @@
 
 int SqliteStorage::_maxRetryCount = 150;
 
+// Interval for checkpointing the write-ahead log, in addition to SQLite's automatic checkpoints on commit
+const int walCheckpointInterval = 5 * 60 * 1000;
+
 SqliteStorage::SqliteStorage(QObject* parent)
     : AbstractSqlStorage(parent)
 {}
 
+void SqliteStorage::setConnectionProperties(const QVariantMap& properties, const QProcessEnvironment& environment, bool loadFromEnvironment)
+{
+    Q_UNUSED(properties);
+    Q_UNUSED(environment);
+    Q_UNUSED(loadFromEnvironment);
+
+    _walMode = Quassel::isOptionSet("sqlite-wal");
+    if (_walMode && !_checkpointTimer) {
+        _checkpointTimer = new QTimer(this);
+        connect(_checkpointTimer, &QTimer::timeout, this, &SqliteStorage::checkpointWal);
+        _checkpointTimer->start(walCheckpointInterval);
+    }
+}
+
+bool SqliteStorage::initDbSession(QSqlDatabase& db)
+{
+    if (!_walMode)
+        return true;
+
+    // The journal mode is stored in the database file, but setting it again is cheap
+    QSqlQuery query = db.exec("PRAGMA journal_mode = WAL");
+    if (!query.first() || query.value(0).toString().compare("wal", Qt::CaseInsensitive) != 0) {
+        qWarning() << "Could not switch the SQLite database to WAL mode, reads and writes may block each other";
+    }
+
+    // In WAL mode, NORMAL is still safe against corruption; only the latest commits may be lost on power failure
+    db.exec("PRAGMA synchronous = NORMAL");
+    // Map up to 256 MiB of the database into memory, and give each connection a page cache of up to 16 MiB
+    db.exec("PRAGMA mmap_size = 268435456");
+    db.exec("PRAGMA cache_size = -16384");
+
+    return true;
+}
+
+void SqliteStorage::checkpointWal()
+{
+    QSqlQuery query = logDb().exec("PRAGMA wal_checkpoint(PASSIVE)");
+    if (query.lastError().isValid())
+        qWarning() << "Could not checkpoint the SQLite write-ahead log:" << query.lastError().text();
+}
+
+void SqliteStorage::unlock()
+{
+    if (_walMode) {
+        // Readers don't take the lock in WAL mode, so only release it if we're holding it for writing
+        if (_writeLockOwner != QThread::currentThread())
+            return;
+    }
+    _writeLockOwner = nullptr;
+    _dbLock.unlock();
+}
+
 bool SqliteStorage::isAvailable() const
 {
     if (!QSqlDatabase::isDriverAvailable("QSQLITE"))
@@ -1212,8 +1268,7 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId& networkId, Bu
 
     BufferInfo bufferInfo;
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_bufferByName"));
+        QSqlQuery query = cachedQuery("select_bufferByName", db);
         query.bindValue(":networkid", networkId.toInt());
         query.bindValue(":userid", user.toInt());
         query.bindValue(":buffercname", buffer.toLower());
@@ -1235,8 +1290,7 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId& networkId, Bu
         }
         else if (create) {
             // let's create the buffer
-            QSqlQuery createQuery(db);
-            createQuery.prepare(queryString("insert_buffer"));
+            QSqlQuery createQuery = cachedQuery("insert_buffer", db);
             createQuery.bindValue(":userid", user.toInt());
             createQuery.bindValue(":networkid", networkId.toInt());
             createQuery.bindValue(":buffertype", (int)type);
@@ -1246,6 +1300,13 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId& networkId, Bu
 
             unlock();
             lockForWrite();
+            // Another thread may have written in the meantime, which would keep a WAL mode transaction that already
+            // read from an older snapshot from writing
+            if (_walMode) {
+                query.finish();
+                db.rollback();
+                db.transaction();
+            }
             safeExec(createQuery);
             watchQuery(createQuery);
             bufferInfo = BufferInfo(createQuery.lastInsertId().toInt(), networkId, type, 0, buffer);
@@ -1263,8 +1324,7 @@ BufferInfo SqliteStorage::getBufferInfo(UserId user, const BufferId& bufferId)
 
     BufferInfo bufferInfo;
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_buffer_by_id"));
+        QSqlQuery query = cachedQuery("select_buffer_by_id", db);
         query.bindValue(":userid", user.toInt());
         query.bindValue(":bufferid", bufferId.toInt());
 
@@ -1279,6 +1339,7 @@ BufferInfo SqliteStorage::getBufferInfo(UserId user, const BufferId& bufferId)
                                     query.value(4).toString());
             Q_ASSERT(!query.next());
         }
+        query.finish();
         db.commit();
     }
     unlock();
@@ -1484,8 +1545,7 @@ QHash<BufferId, MsgId> SqliteStorage::bufferLastMsgIds(UserId user)
 
     bool error = false;
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_buffer_last_messages"));
+        QSqlQuery query = cachedQuery("select_buffer_last_messages", db);
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
@@ -1509,8 +1569,7 @@ void SqliteStorage::setBufferLastSeenMsg(UserId user, const BufferId& bufferId,
     db.transaction();
 
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("update_buffer_lastseen"));
+        QSqlQuery query = cachedQuery("update_buffer_lastseen", db);
         query.bindValue(":userid", user.toInt());
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":lastseenmsgid", msgId.toQint64());
@@ -1532,8 +1591,7 @@ QHash<BufferId, MsgId> SqliteStorage::bufferLastSeenMsgIds(UserId user)
 
     bool error = false;
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_buffer_lastseen_messages"));
+        QSqlQuery query = cachedQuery("select_buffer_lastseen_messages", db);
         query.bindValue(":userid", user.toInt());
 
         lockForRead();
@@ -1557,8 +1615,7 @@ void SqliteStorage::setBufferMarkerLineMsg(UserId user, const BufferId& bufferId
     db.transaction();
 
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("update_buffer_markerlinemsgid"));
+        QSqlQuery query = cachedQuery("update_buffer_markerlinemsgid", db);
         query.bindValue(":userid", user.toInt());
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":markerlinemsgid", msgId.toQint64());
@@ -1605,8 +1662,7 @@ void SqliteStorage::setBufferActivity(UserId user, BufferId bufferId, Message::T
     db.transaction();
 
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("update_buffer_bufferactivity"));
+        QSqlQuery query = cachedQuery("update_buffer_bufferactivity", db);
         query.bindValue(":userid", user.toInt());
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":bufferactivity", (int)bufferActivity);
@@ -1654,8 +1710,7 @@ Message::Types SqliteStorage::bufferActivity(BufferId bufferId, MsgId lastSeenMs
 
     Message::Types result{};
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_buffer_bufferactivity"));
+        QSqlQuery query = cachedQuery("select_buffer_bufferactivity", db);
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
 
@@ -1663,6 +1718,7 @@ Message::Types SqliteStorage::bufferActivity(BufferId bufferId, MsgId lastSeenMs
         safeExec(query);
         if (query.first())
             result = Message::Types(query.value(0).toInt());
+        query.finish();
     }
 
     db.commit();
@@ -1720,8 +1776,7 @@ void SqliteStorage::setHighlightCount(UserId user, BufferId bufferId, int count)
     db.transaction();
 
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("update_buffer_highlightcount"));
+        QSqlQuery query = cachedQuery("update_buffer_highlightcount", db);
         query.bindValue(":userid", user.toInt());
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":highlightcount", count);
@@ -1769,8 +1824,7 @@ int SqliteStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
 
     int result = 0;
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_buffer_highlightcount"));
+        QSqlQuery query = cachedQuery("select_buffer_highlightcount", db);
         query.bindValue(":bufferid", bufferId.toInt());
         query.bindValue(":lastseenmsgid", lastSeenMsgId.toQint64());
 
@@ -1778,6 +1832,7 @@ int SqliteStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
         safeExec(query);
         if (query.first())
             result = query.value(0).toInt();
+        query.finish();
     }
 
     db.commit();
@@ -1792,8 +1847,7 @@ bool SqliteStorage::logMessage(Message& msg)
 
     bool error = false;
     {
-        QSqlQuery logMessageQuery(db);
-        logMessageQuery.prepare(queryString("insert_message"));
+        QSqlQuery logMessageQuery = cachedQuery("insert_message", db);
         // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
         // seconds.  This nets us more precision as well as simplifying 64-bit time.
         logMessageQuery.bindValue(":time", msg.timestamp().toMSecsSinceEpoch());
@@ -1812,8 +1866,7 @@ bool SqliteStorage::logMessage(Message& msg)
         if (logMessageQuery.lastError().isValid()) {
             // constraint violation - must be NOT NULL constraint - probably the sender is missing...
             if (logMessageQuery.lastError().nativeErrorCode() == QLatin1String{"19"}) {
-                QSqlQuery addSenderQuery(db);
-                addSenderQuery.prepare(queryString("insert_sender"));
+                QSqlQuery addSenderQuery = cachedQuery("insert_sender", db);
                 addSenderQuery.bindValue(":sender", msg.sender());
                 addSenderQuery.bindValue(":realname", msg.realName());
                 addSenderQuery.bindValue(":avatarurl", msg.avatarUrl());
@@ -1854,8 +1907,7 @@ bool SqliteStorage::logMessages(MessageList& msgs)
 
     {
         QSet<SenderData> senders;
-        QSqlQuery addSenderQuery(db);
-        addSenderQuery.prepare(queryString("insert_sender"));
+        QSqlQuery addSenderQuery = cachedQuery("insert_sender", db);
         lockForWrite();
         for (int i = 0; i < msgs.count(); i++) {
             auto& msg = msgs.at(i);
@@ -1873,8 +1925,7 @@ bool SqliteStorage::logMessages(MessageList& msgs)
 
     bool error = false;
     {
-        QSqlQuery logMessageQuery(db);
-        logMessageQuery.prepare(queryString("insert_message"));
+        QSqlQuery logMessageQuery = cachedQuery("insert_message", db);
         for (int i = 0; i < msgs.count(); i++) {
             Message& msg = msgs[i];
             // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
@@ -1922,75 +1973,105 @@ std::vector<Message> SqliteStorage::requestMsgs(UserId user, BufferId bufferId,
     QSqlDatabase db = logDb();
     db.transaction();
 
-    bool error = false;
-    BufferInfo bufferInfo;
-    {
-        // code duplication from getBufferInfo:
-        // this is due to the impossibility of nesting transactions and recursive locking
-        QSqlQuery bufferInfoQuery(db);
-        bufferInfoQuery.prepare(queryString("select_buffer_by_id"));
-        bufferInfoQuery.bindValue(":userid", user.toInt());
-        bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
-
-        lockForRead();
-        safeExec(bufferInfoQuery);
-        error = !watchQuery(bufferInfoQuery) || !bufferInfoQuery.first();
-        if (!error) {
-            bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
-                                    bufferInfoQuery.value(1).toInt(),
-                                    (BufferInfo::Type)bufferInfoQuery.value(2).toInt(),
-                                    0,
-                                    bufferInfoQuery.value(4).toString());
-            error = !bufferInfo.isValid();
-        }
-    }
-    if (error) {
+    // code duplication from getBufferInfo:
+    // this is due to the impossibility of nesting transactions and recursive locking
+    lockForRead();
+    BufferInfo bufferInfo = selectBufferInfo(db, user, bufferId);
+    if (!bufferInfo.isValid()) {
         db.rollback();
         unlock();
         return messagelist;
     }
 
-    {
-        QSqlQuery query(db);
-        if (last == -1 && first == -1) {
-            query.prepare(queryString("select_messagesNewestK"));
-        }
-        else if (last == -1) {
-            query.prepare(queryString("select_messagesNewerThan"));
-            query.bindValue(":firstmsg", first.toQint64());
-        }
-        else {
-            query.prepare(queryString("select_messagesRange"));
-            query.bindValue(":lastmsg", last.toQint64());
-            query.bindValue(":firstmsg", first.toQint64());
-        }
-        query.bindValue(":bufferid", bufferId.toInt());
-        query.bindValue(":limit", limit);
+    selectMsgs(db, bufferInfo, first, last, limit, messagelist);
+    db.commit();
+    unlock();
 
-        safeExec(query);
-        watchQuery(query);
+    return messagelist;
+}
 
-        while (query.next()) {
-            Message msg(
-                // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
-                // seconds.  This nets us more precision as well as simplifying 64-bit time.
-                QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong()),
-                bufferInfo,
-                (Message::Type)query.value(2).toInt(),
-                query.value(8).toString(),
-                query.value(4).toString(),
-                query.value(5).toString(),
-                query.value(6).toString(),
-                query.value(7).toString(),
-                (Message::Flags)query.value(3).toInt());
-            msg.setMsgId(query.value(0).toLongLong());
-            messagelist.push_back(std::move(msg));
-        }
+std::vector<std::vector<Message>> SqliteStorage::requestMsgsBatch(UserId user, const std::vector<MsgRequest>& requests)
+{
+    std::vector<std::vector<Message>> results(requests.size());
+    if (requests.empty())
+        return results;
+
+    QSqlDatabase db = logDb();
+    db.transaction();
+
+    // A single lock and transaction for the whole batch, so a client fetching backlog for all
+    // of its buffers at login does not contend with the message writer once per buffer
+    lockForRead();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const MsgRequest& request = requests[i];
+        BufferInfo bufferInfo = selectBufferInfo(db, user, request.bufferId);
+        if (!bufferInfo.isValid())
+            continue;
+        selectMsgs(db, bufferInfo, request.first, request.last, request.limit, results[i]);
     }
     db.commit();
     unlock();
 
-    return messagelist;
+    return results;
+}
+
+BufferInfo SqliteStorage::selectBufferInfo(QSqlDatabase& db, UserId user, BufferId bufferId)
+{
+    BufferInfo bufferInfo;
+    QSqlQuery bufferInfoQuery = cachedQuery("select_buffer_by_id", db);
+    bufferInfoQuery.bindValue(":userid", user.toInt());
+    bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
+
+    safeExec(bufferInfoQuery);
+    if (watchQuery(bufferInfoQuery) && bufferInfoQuery.first()) {
+        bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
+                                bufferInfoQuery.value(1).toInt(),
+                                (BufferInfo::Type)bufferInfoQuery.value(2).toInt(),
+                                0,
+                                bufferInfoQuery.value(4).toString());
+    }
+    bufferInfoQuery.finish();
+    return bufferInfo;
+}
+
+void SqliteStorage::selectMsgs(
+    QSqlDatabase& db, const BufferInfo& bufferInfo, MsgId first, MsgId last, int limit, std::vector<Message>& messagelist)
+{
+    QSqlQuery query;
+    if (last == -1 && first == -1) {
+        query = cachedQuery("select_messagesNewestK", db);
+    }
+    else if (last == -1) {
+        query = cachedQuery("select_messagesNewerThan", db);
+        query.bindValue(":firstmsg", first.toQint64());
+    }
+    else {
+        query = cachedQuery("select_messagesRange", db);
+        query.bindValue(":lastmsg", last.toQint64());
+        query.bindValue(":firstmsg", first.toQint64());
+    }
+    query.bindValue(":bufferid", bufferInfo.bufferId().toInt());
+    query.bindValue(":limit", limit);
+
+    safeExec(query);
+    watchQuery(query);
+
+    while (query.next()) {
+        Message msg(
+            // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
+            // seconds.  This nets us more precision as well as simplifying 64-bit time.
+            QDateTime::fromMSecsSinceEpoch(query.value(1).toLongLong()),
+            bufferInfo,
+            (Message::Type)query.value(2).toInt(),
+            query.value(8).toString(),
+            query.value(4).toString(),
+            query.value(5).toString(),
+            query.value(6).toString(),
+            query.value(7).toString(),
+            (Message::Flags)query.value(3).toInt());
+        msg.setMsgId(query.value(0).toLongLong());
+        messagelist.push_back(std::move(msg));
+    }
 }
 
 std::vector<Message> SqliteStorage::requestMsgsFiltered(
@@ -2006,8 +2087,7 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
     {
         // code dupication from getBufferInfo:
         // this is due to the impossibility of nesting transactions and recursive locking
-        QSqlQuery bufferInfoQuery(db);
-        bufferInfoQuery.prepare(queryString("select_buffer_by_id"));
+        QSqlQuery bufferInfoQuery = cachedQuery("select_buffer_by_id", db);
         bufferInfoQuery.bindValue(":userid", user.toInt());
         bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
 
@@ -2022,6 +2102,7 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
                                     bufferInfoQuery.value(4).toString());
             error = !bufferInfo.isValid();
         }
+        bufferInfoQuery.finish();
     }
     if (error) {
         db.rollback();
@@ -2030,16 +2111,16 @@ std::vector<Message> SqliteStorage::requestMsgsFiltered(
     }
 
     {
-        QSqlQuery query(db);
+        QSqlQuery query;
         if (last == -1 && first == -1) {
-            query.prepare(queryString("select_messagesNewestK_filtered"));
+            query = cachedQuery("select_messagesNewestK_filtered", db);
         }
         else if (last == -1) {
-            query.prepare(queryString("select_messagesNewerThan_filtered"));
+            query = cachedQuery("select_messagesNewerThan_filtered", db);
             query.bindValue(":firstmsg", first.toQint64());
         }
         else {
-            query.prepare(queryString("select_messagesRange_filtered"));
+            query = cachedQuery("select_messagesRange_filtered", db);
             query.bindValue(":lastmsg", last.toQint64());
             query.bindValue(":firstmsg", first.toQint64());
         }
@@ -2090,8 +2171,7 @@ std::vector<Message> SqliteStorage::requestMsgsForward(
     {
         // code dupication from getBufferInfo:
         // this is due to the impossibility of nesting transactions and recursive locking
-        QSqlQuery bufferInfoQuery(db);
-        bufferInfoQuery.prepare(queryString("select_buffer_by_id"));
+        QSqlQuery bufferInfoQuery = cachedQuery("select_buffer_by_id", db);
         bufferInfoQuery.bindValue(":userid", user.toInt());
         bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
 
@@ -2106,6 +2186,7 @@ std::vector<Message> SqliteStorage::requestMsgsForward(
                                     bufferInfoQuery.value(4).toString());
             error = !bufferInfo.isValid();
         }
+        bufferInfoQuery.finish();
     }
     if (error) {
         db.rollback();
@@ -2114,8 +2195,7 @@ std::vector<Message> SqliteStorage::requestMsgsForward(
     }
 
     {
-        QSqlQuery query(db);
-        query.prepare(queryString("select_messagesForward"));
+        QSqlQuery query = cachedQuery("select_messagesForward", db);
 
         if (first == -1) {
             query.bindValue(":firstmsg", std::numeric_limits<qint64>::min());
@@ -2172,30 +2252,14 @@ std::vector<Message> SqliteStorage::requestAllMsgs(UserId user, MsgId first, Msg
     QSqlDatabase db = logDb();
     db.transaction();
 
-    QHash<BufferId, BufferInfo> bufferInfoHash;
     {
-        QSqlQuery bufferInfoQuery(db);
-        bufferInfoQuery.prepare(queryString("select_buffers"));
-        bufferInfoQuery.bindValue(":userid", user.toInt());
-
         lockForRead();
-        safeExec(bufferInfoQuery);
-        watchQuery(bufferInfoQuery);
-        while (bufferInfoQuery.next()) {
-            BufferInfo bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
-                                               bufferInfoQuery.value(1).toInt(),
-                                               (BufferInfo::Type)bufferInfoQuery.value(2).toInt(),
-                                               bufferInfoQuery.value(3).toInt(),
-                                               bufferInfoQuery.value(4).toString());
-            bufferInfoHash[bufferInfo.bufferId()] = bufferInfo;
-        }
-
-        QSqlQuery query(db);
+        QSqlQuery query;
         if (last == -1) {
-            query.prepare(queryString("select_messagesAllNew"));
+            query = cachedQuery("select_messagesAllNew", db);
         }
         else {
-            query.prepare(queryString("select_messagesAll"));
+            query = cachedQuery("select_messagesAll", db);
             query.bindValue(":lastmsg", last.toQint64());
         }
         query.bindValue(":userid", user.toInt());
@@ -2205,12 +2269,22 @@ std::vector<Message> SqliteStorage::requestAllMsgs(UserId user, MsgId first, Msg
 
         watchQuery(query);
 
+        // The buffer is part of every row, but all messages of a buffer share one BufferInfo
+        QHash<BufferId, BufferInfo> bufferInfoHash;
         while (query.next()) {
+            BufferId bufferId = query.value(1).toInt();
+            if (!bufferInfoHash.contains(bufferId)) {
+                bufferInfoHash[bufferId] = BufferInfo(bufferId,
+                                                      query.value(10).toInt(),
+                                                      (BufferInfo::Type)query.value(11).toInt(),
+                                                      query.value(12).toInt(),
+                                                      query.value(13).toString());
+            }
             Message msg(
                 // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
                 // seconds.  This nets us more precision as well as simplifying 64-bit time.
                 QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong()),
-                bufferInfoHash[query.value(1).toInt()],
+                bufferInfoHash[bufferId],
                 (Message::Type)query.value(3).toInt(),
                 query.value(9).toString(),
                 query.value(5).toString(),
@@ -2234,30 +2308,14 @@ std::vector<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId fi
     QSqlDatabase db = logDb();
     db.transaction();
 
-    QHash<BufferId, BufferInfo> bufferInfoHash;
     {
-        QSqlQuery bufferInfoQuery(db);
-        bufferInfoQuery.prepare(queryString("select_buffers"));
-        bufferInfoQuery.bindValue(":userid", user.toInt());
-
         lockForRead();
-        safeExec(bufferInfoQuery);
-        watchQuery(bufferInfoQuery);
-        while (bufferInfoQuery.next()) {
-            BufferInfo bufferInfo = BufferInfo(bufferInfoQuery.value(0).toInt(),
-                                               bufferInfoQuery.value(1).toInt(),
-                                               (BufferInfo::Type)bufferInfoQuery.value(2).toInt(),
-                                               bufferInfoQuery.value(3).toInt(),
-                                               bufferInfoQuery.value(4).toString());
-            bufferInfoHash[bufferInfo.bufferId()] = bufferInfo;
-        }
-
-        QSqlQuery query(db);
+        QSqlQuery query;
         if (last == -1) {
-            query.prepare(queryString("select_messagesAllNew_filtered"));
+            query = cachedQuery("select_messagesAllNew_filtered", db);
         }
         else {
-            query.prepare(queryString("select_messagesAll_filtered"));
+            query = cachedQuery("select_messagesAll_filtered", db);
             query.bindValue(":lastmsg", last.toQint64());
         }
         query.bindValue(":userid", user.toInt());
@@ -2271,13 +2329,23 @@ std::vector<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId fi
 
         watchQuery(query);
 
+        // The buffer is part of every row, but all messages of a buffer share one BufferInfo
+        QHash<BufferId, BufferInfo> bufferInfoHash;
         while (query.next()) {
+            BufferId bufferId = query.value(1).toInt();
+            if (!bufferInfoHash.contains(bufferId)) {
+                bufferInfoHash[bufferId] = BufferInfo(bufferId,
+                                                      query.value(10).toInt(),
+                                                      (BufferInfo::Type)query.value(11).toInt(),
+                                                      query.value(12).toInt(),
+                                                      query.value(13).toString());
+            }
             Message msg(
                 // As of SQLite schema version 31, timestamps are stored in milliseconds
                 // instead of seconds.  This nets us more precision as well as simplifying
                 // 64-bit time.
                 QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong()),
-                bufferInfoHash[query.value(1).toInt()],
+                bufferInfoHash[bufferId],
                 (Message::Type)query.value(3).toInt(),
                 query.value(9).toString(),
                 query.value(5).toString(),
@@ -20,14 +20,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 
 #include <QReadWriteLock>
 #include <QSqlDatabase>
+#include <QThread>
 
 #include "abstractsqlstorage.h"
 
 class QSqlQuery;
+class QTimer;
 
 class SqliteStorage : public AbstractSqlStorage
 {
@@ -113,6 +116,7 @@ public:
     bool logMessage(Message& msg) override;
     bool logMessages(MessageList& msgs) override;
     std::vector<Message> requestMsgs(UserId user, BufferId bufferId, MsgId first = -1, MsgId last = -1, int limit = -1) override;
+    std::vector<std::vector<Message>> requestMsgsBatch(UserId user, const std::vector<MsgRequest>& requests) override;
     std::vector<Message> requestMsgsFiltered(UserId user,
                                              BufferId bufferId,
                                              MsgId first = -1,
@@ -139,13 +143,9 @@ public:
     QMap<UserId, QString> getAllAuthUserNames() override;
 
 protected:
-    void setConnectionProperties(const QVariantMap& properties, const QProcessEnvironment& environment, bool loadFromEnvironment) override
-    {
-        Q_UNUSED(properties);
-        Q_UNUSED(environment);
-        Q_UNUSED(loadFromEnvironment);
-    }
-    // SQLite does not have any connection properties to set
+    // SQLite does not have any connection properties to set, but this is where we pick up the journal mode
+    void setConnectionProperties(const QVariantMap& properties, const QProcessEnvironment& environment, bool loadFromEnvironment) override;
+    bool initDbSession(QSqlDatabase& db) override;
     QString driverName() override { return "QSQLITE"; }
     QString databaseName() override { return backlogFile(); }
     int installedSchemaVersion() override;
@@ -169,15 +169,37 @@ protected:
 
     bool safeExec(QSqlQuery& query, int retryCount = 0);
 
+private slots:
+    /**
+     * Moves the content of the write-ahead log back into the database, without waiting for readers or writers.
+     */
+    void checkpointWal();
+
 private:
     static QString backlogFile();
     void bindNetworkInfo(QSqlQuery& query, const NetworkInfo& info);
     void bindServerInfo(QSqlQuery& query, const Network::Server& server);
+    // Helpers for requestMsgs() and requestMsgsBatch(); expect an open transaction and a held lock
+    BufferInfo selectBufferInfo(QSqlDatabase& db, UserId user, BufferId bufferId);
+    void selectMsgs(QSqlDatabase& db, const BufferInfo& bufferInfo, MsgId first, MsgId last, int limit, std::vector<Message>& messagelist);
+
+    // In WAL mode, readers work on a snapshot of the database and don't need to be locked out while writing
+    inline void lockForRead()
+    {
+        if (!_walMode)
+            _dbLock.lockForRead();
+    }
+    inline void lockForWrite()
+    {
+        _dbLock.lockForWrite();
+        _writeLockOwner = QThread::currentThread();
+    }
+    void unlock();
 
-    inline void lockForRead() { _dbLock.lockForRead(); }
-    inline void lockForWrite() { _dbLock.lockForWrite(); }
-    inline void unlock() { _dbLock.unlock(); }
     QReadWriteLock _dbLock;
+    std::atomic<QThread*> _writeLockOwner{nullptr};  ///< Thread holding the write lock, needed for unlock() in WAL mode
+    bool _walMode{false};
+    QTimer* _checkpointTimer{nullptr};
     static int _maxRetryCount;
 };
 
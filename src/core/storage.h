@@ -56,6 +56,15 @@ public:
 
     };
 
+    //! A single buffer's part of a batched backlog request, see requestMsgsBatch()
+    struct MsgRequest
+    {
+        BufferId bufferId;
+        MsgId first{-1};
+        MsgId last{-1};
+        int limit{-1};
+    };
+
     /* General */
 
     //! Check if the storage type is available.
@@ -544,6 +553,14 @@ public:
                                                     Message::Types type = Message::Types{-1},
                                                     Message::Flags flags = Message::Flags{-1}) = 0;
 
+    //! Request messages for several buffers at once.
+    /** All requests are served from a single transaction, which is a lot cheaper than issuing
+     *  one requestMsgs() call per buffer when a client fetches backlog for all of its buffers.
+     *  \param requests The per-buffer requests, with the same semantics as for requestMsgs()
+     *  \return One list of messages per request, in request order; empty for unknown buffers
+     */
+    virtual std::vector<std::vector<Message>> requestMsgsBatch(UserId user, const std::vector<MsgRequest>& requests) = 0;
+
     //! Request a certain number of messages across all buffers
     /** \param first    if != -1 return only messages with a MsgId >= first
      *  \param last     if != -1 return only messages with a MsgId < last
@@ -32,6 +32,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QTextLayout>
+#include <QtMath>
 
 #include "action.h"
 #include "buffermodel.h"
@@ -119,9 +120,10 @@ QTextLayout* ChatItem::layout() const
     if (_cachedLayout)
         return _cachedLayout;
 
+    // Register first: this may clear the caches of lines far from the viewport, possibly including our own
+    chatView()->setHasCache(chatLine());
     _cachedLayout = new QTextLayout;
     initLayout(_cachedLayout);
-    chatView()->setHasCache(chatLine());
     return _cachedLayout;
 }
 
@@ -631,8 +633,15 @@ ContentsChatItemPrivate* ContentsChatItem::privateData() const
 qreal ContentsChatItem::setGeometryByWidth(qreal w)
 {
     // We use this for reloading layout info as well, so we can't bail out if the width doesn't change
+    qreal h = heightForWidth(w);
+    if (w != width() || h != height())
+        setGeometry(w, h);
 
-    // compute height
+    return h;
+}
+
+qreal ContentsChatItem::heightForWidth(qreal w)
+{
     int lines = 1;
     WrapColumnFinder finder(this);
     while (finder.nextWrapColumn(w) > 0)
@@ -641,6 +650,19 @@ qreal ContentsChatItem::setGeometryByWidth(qreal w)
     qreal h = lines * spacing;
     delete _data;
     _data = nullptr;
+    return h;
+}
+
+qreal ContentsChatItem::setGeometryByEstimate(qreal w)
+{
+    // Assume the text fills up every line but the last. This is off by a line at most for most messages,
+    // and much cheaper than finding the actual wrap columns.
+    int lines = 1;
+    ChatLineModel::WrapList wrapList = data(ChatLineModel::WrapListRole).value<ChatLineModel::WrapList>();
+    if (!wrapList.isEmpty() && w > 0)
+        lines = qMax(1, qCeil(wrapList.last().endX / w));
+    qreal spacing = qMax(fontMetrics()->lineSpacing(), fontMetrics()->height());  // cope with negative leading()
+    qreal h = lines * spacing;
 
     if (w != width() || h != height())
         setGeometry(w, h);
@@ -247,6 +247,9 @@ private:
     void clearWebPreview();
 
     qreal setGeometryByWidth(qreal w);
+    qreal setGeometryByEstimate(qreal w);
+    // Wraps the contents to compute their height for the given width, without changing the geometry
+    qreal heightForWidth(qreal w);
 
     QFontMetricsF* _fontMetrics;
 
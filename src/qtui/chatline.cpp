@@ -65,6 +65,8 @@ ChatLine::ChatLine(int row,
     , _width(width)
     , _height(_contentsItem.height())
     , _selection(0)
+    , _layoutPending(false)
+    , _measuredHeight(-1)
     , _mouseGrabberItem(nullptr)
     , _hoverItem(nullptr)
 {
@@ -143,6 +145,7 @@ void ChatLine::setSecondColumn(const qreal& senderWidth, const qreal& contentsWi
 {
     // linepos is the *bottom* position for the line
     qreal height = _contentsItem.setGeometryByWidth(contentsWidth);
+    _layoutPending = false;
     linePos -= height;
     bool needGeometryChange = (height != _height);
 
@@ -162,6 +165,35 @@ void ChatLine::setGeometryByWidth(const qreal& width, const qreal& contentsWidth
 {
     // linepos is the *bottom* position for the line
     qreal height = _contentsItem.setGeometryByWidth(contentsWidth);
+    _layoutPending = false;
+    setGeometry(width, height, linePos);
+}
+
+void ChatLine::setGeometryByEstimate(const qreal& width, const qreal& contentsWidth, qreal& linePos)
+{
+    qreal height = _contentsItem.setGeometryByEstimate(contentsWidth);
+    _layoutPending = true;
+    _measuredHeight = -1;
+    setGeometry(width, height, linePos);
+}
+
+void ChatLine::measureHeight(const qreal& contentsWidth)
+{
+    _measuredHeight = _contentsItem.heightForWidth(contentsWidth);
+}
+
+void ChatLine::setGeometryByMeasurement(const qreal& width, const qreal& contentsWidth, qreal& linePos)
+{
+    qreal height = _measuredHeight;
+    if (contentsWidth != _contentsItem.width() || height != _contentsItem.height())
+        _contentsItem.setGeometry(contentsWidth, height);
+    _layoutPending = false;
+    _measuredHeight = -1;
+    setGeometry(width, height, linePos);
+}
+
+void ChatLine::setGeometry(const qreal& width, const qreal& height, qreal& linePos)
+{
     linePos -= height;
     bool needGeometryChange = (height != _height || width != _width);
 
@@ -85,6 +85,15 @@ public:
     // the _bottom_ position is passed via linePos. linePos is updated to the top of the chatLine.
     void setSecondColumn(const qreal& senderWidth, const qreal& contentsWidth, const QPointF& contentsPos, qreal& linePos);
     void setGeometryByWidth(const qreal& width, const qreal& contentsWidth, qreal& linePos);
+    // Like setGeometryByWidth(), but only estimates the height instead of wrapping the contents.
+    // The line's layout stays pending until one of the methods above is called for it.
+    void setGeometryByEstimate(const qreal& width, const qreal& contentsWidth, qreal& linePos);
+    inline bool isLayoutPending() const { return _layoutPending; }
+    // Computes the real height of a pending line without moving anything yet, so the scene can measure many lines
+    // and reposition them all at once. setGeometryByMeasurement() then applies the measured height.
+    void measureHeight(const qreal& contentsWidth);
+    inline bool hasMeasuredHeight() const { return _layoutPending && _measuredHeight >= 0; }
+    void setGeometryByMeasurement(const qreal& width, const qreal& contentsWidth, qreal& linePos);
 
     void setSelected(bool selected, ChatLineModel::ColumnType minColumn = ChatLineModel::ContentsColumn);
     void setHighlighted(bool highlighted);
@@ -108,6 +117,8 @@ protected:
     void setMouseGrabberItem(ChatItem* item);
 
 private:
+    void setGeometry(const qreal& width, const qreal& height, qreal& linePos);
+
     int _row;
     QAbstractItemModel* _model;
     ContentsChatItem _contentsItem;
@@ -126,6 +137,8 @@ private:
     // _selection[6] ...... Selected
     // _selection[7] ...... Highlighted
     quint8 _selection;  // save space, so we put both the col and the flags into one byte
+    bool _layoutPending;
+    qreal _measuredHeight;  // only valid while the layout is pending, see measureHeight()
 
     ChatItem* _mouseGrabberItem;
     ChatItem* _hoverItem;
@@ -20,6 +20,7 @@
 
 #include "chatscene.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QApplication>
@@ -31,6 +32,7 @@
 #include <QMenuBar>
 #include <QMimeData>
 #include <QPersistentModelIndex>
+#include <QScrollBar>
 #include <QUrl>
 
 #ifdef HAVE_WEBENGINE
@@ -58,6 +60,11 @@
 
 const qreal minContentsWidth = 200;
 
+// Scenes with more lines than this only lay out the lines around the viewport right away when resized
+const int maxEagerLayoutLines = 500;
+// Number of pending lines measured in one go while idle
+const int pendingLayoutBatchSize = 200;
+
 ChatScene::ChatScene(QAbstractItemModel* model, QString idString, qreal width, ChatView* parent)
     : QGraphicsScene(0, 0, width, 0, (QObject*)parent)
     , _chatView(parent)
@@ -76,6 +83,8 @@ ChatScene::ChatScene(QAbstractItemModel* model, QString idString, qreal width, C
     , _selectingItem(nullptr)
     , _selectionStart(-1)
     , _isSelecting(false)
+    , _pendingLayoutTop(-1)
+    , _pendingLayoutBottom(-1)
     , _clickMode(NoClick)
     , _clickHandled(true)
     , _leftButtonPressed(false)
@@ -140,6 +149,10 @@ ChatScene::ChatScene(QAbstractItemModel* model, QString idString, qreal width, C
     _clickTimer.setSingleShot(true);
     connect(&_clickTimer, &QTimer::timeout, this, &ChatScene::clickTimeout);
 
+    _layoutTimer.setInterval(0);
+    _layoutTimer.setSingleShot(true);
+    connect(&_layoutTimer, &QTimer::timeout, this, &ChatScene::layoutPendingLines);
+
     setItemIndexMethod(QGraphicsScene::NoIndex);
 }
 
@@ -559,7 +572,137 @@ void ChatScene::setWidth(qreal width)
 {
     if (width == _sceneRect.width())
         return;
-    layout(0, _lines.count() - 1, width);
+
+    if (_lines.count() <= maxEagerLayoutLines) {
+        layout(0, _lines.count() - 1, width);
+        return;
+    }
+
+    // Wrapping every single line of a long buffer stalls the UI for ages. Only lay out the lines in and around the
+    // viewport properly, give all others an estimated height and lay them out in idle time (see layoutPendingLines()).
+    int first, last;
+    viewportRows(first, last, 1);
+
+    int row = _lines.count() - 1;
+    qreal linePos = _lines.at(row)->scenePos().y() + _lines.at(row)->height();
+    qreal contentsWidth = width - secondColumnHandle()->sceneRight();
+    while (row >= 0) {
+        ChatLine* line = _lines.at(row);
+        if (row >= first && row <= last)
+            line->setGeometryByWidth(width, contentsWidth, linePos);
+        else
+            line->setGeometryByEstimate(width, contentsWidth, linePos);
+        row--;
+    }
+
+    updateSceneRect(width);
+    setHandleXLimits();
+    setMarkerLine();
+    emit layoutChanged();
+
+    _pendingLayoutTop = first;
+    _pendingLayoutBottom = last;
+    _layoutTimer.start();
+}
+
+void ChatScene::layoutPendingLines()
+{
+    if (_lines.isEmpty())
+        return;
+
+    // Repositioning touches every line above the changed ones, so doing that per batch would be quadratic.
+    // Instead, only measure the pending lines here, and move them into place all at once when done.
+    qreal contentsWidth = _sceneRect.width() - secondColumnHandle()->sceneRight();
+    int lastRow = _lines.count() - 1;
+
+    // Lines in the viewport can't wait, as they might have been scrolled into view with an estimated height
+    int first, last;
+    viewportRows(first, last);
+    bool viewportPending = false;
+    for (int row = first; row <= last; row++) {
+        ChatLine* line = _lines.at(row);
+        if (line->isLayoutPending()) {
+            if (!line->hasMeasuredHeight())
+                line->measureHeight(contentsWidth);
+            viewportPending = true;
+        }
+    }
+
+    // Continue growing the window of scanned rows around the viewport until it holds another batch of pending lines.
+    // Rows might have been inserted or removed in the meantime; anything missed is caught by applyMeasuredLayouts().
+    int top = qBound(0, _pendingLayoutTop, lastRow);
+    int bottom = qBound(top, _pendingLayoutBottom, lastRow);
+    int measured = 0;
+    while (measured < pendingLayoutBatchSize && (top > 0 || bottom < lastRow)) {
+        if (bottom < lastRow) {
+            ChatLine* line = _lines.at(++bottom);
+            if (line->isLayoutPending() && !line->hasMeasuredHeight()) {
+                line->measureHeight(contentsWidth);
+                measured++;
+            }
+        }
+        if (top > 0) {
+            ChatLine* line = _lines.at(--top);
+            if (line->isLayoutPending() && !line->hasMeasuredHeight()) {
+                line->measureHeight(contentsWidth);
+                measured++;
+            }
+        }
+    }
+    _pendingLayoutTop = top;
+    _pendingLayoutBottom = bottom;
+
+    bool done = top == 0 && bottom == lastRow;
+    if (viewportPending || done)
+        applyMeasuredLayouts();
+
+    if (_pendingLayoutTop > 0 || _pendingLayoutBottom < _lines.count() - 1)
+        _layoutTimer.start();
+}
+
+void ChatScene::applyMeasuredLayouts()
+{
+    // The scene is anchored at the bottom, so laying out lines below the viewport moves its contents.
+    // Compensate for that, so the user doesn't see the text jump around.
+    int first, last;
+    viewportRows(first, last);
+    ChatLine* anchorLine = _lines.at(first);
+    qreal anchorPos = anchorLine->scenePos().y();
+    qreal viewTop = _chatView ? _chatView->mapToScene(0, 0).y() : 0;
+
+    qreal width = _sceneRect.width();
+    qreal contentsWidth = width - secondColumnHandle()->sceneRight();
+    int row = _lines.count() - 1;
+    qreal linePos = _lines.at(row)->scenePos().y() + _lines.at(row)->height();
+    int missed = -1;
+    for (; row >= 0; row--) {
+        ChatLine* line = _lines.at(row);
+        if (line->hasMeasuredHeight()) {
+            line->setGeometryByMeasurement(width, contentsWidth, linePos);
+        }
+        else {
+            linePos -= line->height();
+            line->setPos(0, linePos);
+            if (line->isLayoutPending() && missed < 0)
+                missed = row;
+        }
+    }
+
+    updateSceneRect(width);
+    setMarkerLine();
+    emit layoutChanged();
+
+    qreal offset = anchorLine->scenePos().y() - anchorPos;
+    if (offset != 0 && _chatView) {
+        QScrollBar* vbar = _chatView->verticalScrollBar();
+        vbar->setValue(qRound((viewTop + offset - _sceneRect.top()) * _chatView->transform().m22()));
+    }
+
+    // Rows inserted while we were busy can shift pending lines out of the scanned window; start over from one of them
+    if (missed >= 0 && _pendingLayoutTop == 0 && _pendingLayoutBottom == _lines.count() - 1) {
+        _pendingLayoutTop = _pendingLayoutBottom = missed;
+        _layoutTimer.start();
+    }
 }
 
 void ChatScene::layout(int start, int end, qreal width)
@@ -1106,6 +1249,30 @@ int ChatScene::rowByScenePos(qreal y) const
     return -1;
 }
 
+int ChatScene::rowAtScenePos(qreal y) const
+{
+    if (_lines.isEmpty())
+        return -1;
+
+    // Lines are stacked without gaps, so their positions are sorted
+    auto it = std::upper_bound(_lines.cbegin(), _lines.cend(), y, [](qreal pos, ChatLine* line) { return pos < line->scenePos().y(); });
+    if (it == _lines.cbegin())
+        return 0;
+    return int(it - _lines.cbegin()) - 1;
+}
+
+void ChatScene::viewportRows(int& first, int& last, qreal margin) const
+{
+    if (!_chatView) {
+        first = 0;
+        last = _lines.count() - 1;
+        return;
+    }
+    QRectF viewRect = _chatView->mapToScene(_chatView->viewport()->rect()).boundingRect();
+    first = rowAtScenePos(viewRect.top() - margin * viewRect.height());
+    last = rowAtScenePos(viewRect.bottom() + margin * viewRect.height());
+}
+
 void ChatScene::updateSceneRect(qreal width)
 {
     if (_lines.isEmpty()) {
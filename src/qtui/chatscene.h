@@ -227,10 +227,20 @@ private slots:
 
     void clickTimeout();
 
+    //! Measures another batch of lines whose geometry is still estimated, starting close to the viewport
+    void layoutPendingLines();
+
 private:
     void setHandleXLimits();
     void updateSelection(const QPointF& pos);
 
+    //! Returns the row of the line at the given position, or the closest row if there is no line there
+    int rowAtScenePos(qreal y) const;
+    //! Determines the rows in the viewport, extended by the given number of viewport heights on either side
+    void viewportRows(int& first, int& last, qreal margin = 0) const;
+    //! Applies the heights of all measured pending lines in a single pass, keeping the viewport contents in place
+    void applyMeasuredLayouts();
+
     ChatView* _chatView;
     QString _idString;
     QAbstractItemModel* _model;
@@ -263,6 +273,9 @@ private:
     int _firstSelectionRow;
     bool _isSelecting;
 
+    QTimer _layoutTimer;  ///< Lays out pending lines in idle time, see setWidth()
+    int _pendingLayoutTop, _pendingLayoutBottom;  ///< Rows already scanned for pending lines, see layoutPendingLines()
+
     QTimer _clickTimer;
     ClickMode _clickMode;
     QPointF _clickPos;
@@ -37,6 +37,9 @@
 #include "qtuistyle.h"
 #include "util.h"
 
+// Number of lines allowed to keep a text layout before those outside the viewport are dropped
+const int maxCachedLayouts = 512;
+
 ChatView::ChatView(BufferId bufferId, QWidget* parent)
     : QGraphicsView(parent)
     , AbstractChatView()
@@ -426,8 +429,13 @@ void ChatView::scrollContentsBy(int dx, int dy)
 
 void ChatView::setHasCache(ChatLine* line, bool hasCache)
 {
-    if (hasCache)
+    if (hasCache) {
+        // Text layouts are big; things like searching can create them for far more lines than are visible,
+        // so drop those outside the viewport before they pile up
+        if (_linesWithCache.count() >= maxCachedLayouts)
+            checkChatLineCaches();
         _linesWithCache.insert(line);
+    }
     else
         _linesWithCache.remove(line);
 }
@@ -43,6 +43,7 @@
 #endif
 
 #include "aboutdlg.h"
+#include "abstractmessageprocessor.h"
 #include "action.h"
 #include "actioncollection.h"
 #include "awaylogfilter.h"
@@ -1237,6 +1238,7 @@ void MainWin::setConnectedState()
                &MsgProcessorStatusWidget::setProgress);
     disconnect(Client::backlogManager(), &ClientBacklogManager::messagesRequested, this, &MainWin::showStatusBarMessage);
     disconnect(Client::backlogManager(), &ClientBacklogManager::messagesProcessed, this, &MainWin::showStatusBarMessage);
+    disconnect(Client::messageProcessor(), &AbstractMessageProcessor::messagesProcessed, this, &MainWin::showStatusBarMessage);
     if (!Client::internalCore()) {
         connect(Client::backlogManager(),
                 &ClientBacklogManager::updateProgress,
@@ -1244,6 +1246,7 @@ void MainWin::setConnectedState()
                 &MsgProcessorStatusWidget::setProgress);
         connect(Client::backlogManager(), &ClientBacklogManager::messagesRequested, this, &MainWin::showStatusBarMessage);
         connect(Client::backlogManager(), &ClientBacklogManager::messagesProcessed, this, &MainWin::showStatusBarMessage);
+        connect(Client::messageProcessor(), &AbstractMessageProcessor::messagesProcessed, this, &MainWin::showStatusBarMessage);
     }
 
     // _viewMenu->setEnabled(true);
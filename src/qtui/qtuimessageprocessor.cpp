@@ -20,12 +20,17 @@
 
 #include "qtuimessageprocessor.h"
 
+#include <QElapsedTimer>
+
 #include "client.h"
 #include "clientsettings.h"
 #include "identity.h"
 #include "messagemodel.h"
 #include "network.h"
 
+// Time spent processing queued messages before returning to the event loop, in milliseconds
+const int processTimeSlice = 8;
+
 QtUiMessageProcessor::QtUiMessageProcessor(QObject* parent)
     : AbstractMessageProcessor(parent)
     , _processing(false)
@@ -42,7 +47,7 @@ QtUiMessageProcessor::QtUiMessageProcessor(QObject* parent)
     notificationSettings.notify("Highlights/HighlightNick", this, &QtUiMessageProcessor::highlightNickChanged);
 
     _processTimer.setInterval(0);
-    connect(&_processTimer, &QTimer::timeout, this, &QtUiMessageProcessor::processNextMessage);
+    connect(&_processTimer, &QTimer::timeout, this, &QtUiMessageProcessor::processQueuedMessages);
 }
 
 void QtUiMessageProcessor::reset()
@@ -52,31 +57,28 @@ void QtUiMessageProcessor::reset()
             _processTimer.stop();
         _processing = false;
         _currentBatch.clear();
+        _currentBatchPos = 0;
         _processQueue.clear();
     }
 }
 
 void QtUiMessageProcessor::process(Message& msg)
 {
-    checkForHighlight(msg);
+    NetworkStateCache networkStates;
+    checkForHighlight(msg, networkStates);
     preProcess(msg);
     Client::messageModel()->insertMessage(msg);
 }
 
 void QtUiMessageProcessor::process(QList<Message>& msgs)
 {
-    QList<Message>::iterator msgIter = msgs.begin();
-    QList<Message>::iterator msgIterEnd = msgs.end();
-    while (msgIter != msgIterEnd) {
-        checkForHighlight(*msgIter);
-        preProcess(*msgIter);
-        ++msgIter;
-    }
-    Client::messageModel()->insertMessages(msgs);
-    return;
-
     if (msgs.isEmpty())
         return;
+    if (!isProcessing()) {
+        _runTimer.start();
+        _runCount = 0;
+    }
+    _runCount += msgs.count();
     _processQueue.append(msgs);
     if (!isProcessing())
         startProcessing();
@@ -93,42 +95,77 @@ void QtUiMessageProcessor::startProcessing()
     }
 }
 
-void QtUiMessageProcessor::processNextMessage()
+void QtUiMessageProcessor::processQueuedMessages()
 {
-    if (_currentBatch.isEmpty()) {
-        if (_processQueue.isEmpty()) {
-            _processTimer.stop();
-            _processing = false;
-            return;
+    // Process as many messages as fit into one time slice, so a large backlog neither blocks the UI
+    // nor takes one event loop iteration per message
+    QElapsedTimer timer;
+    timer.start();
+    NetworkStateCache networkStates;
+    do {
+        if (_currentBatchPos >= _currentBatch.count()) {
+            if (_processQueue.isEmpty()) {
+                _processTimer.stop();
+                _processing = false;
+                _currentBatch.clear();
+                _currentBatchPos = 0;
+                emit messagesProcessed(tr("Processed %n message(s) in %1 seconds.", "", _runCount)
+                                           .arg(_runTimer.elapsed() / 1000.0, 0, 'f', 2));
+                return;
+            }
+            _currentBatch = _processQueue.takeFirst();
+            _currentBatchPos = 0;
+        }
+
+        int start = _currentBatchPos;
+        do {
+            Message& msg = _currentBatch[_currentBatchPos++];
+            checkForHighlight(msg, networkStates);
+            preProcess(msg);
+        } while (_currentBatchPos < _currentBatch.count() && !timer.hasExpired(processTimeSlice));
+
+        if (start == 0 && _currentBatchPos == _currentBatch.count())
+            Client::messageModel()->insertMessages(_currentBatch);
+        else
+            Client::messageModel()->insertMessages(_currentBatch.mid(start, _currentBatchPos - start));
+    } while (!timer.hasExpired(processTimeSlice));
+}
+
+QtUiMessageProcessor::NetworkState QtUiMessageProcessor::networkState(NetworkId netId)
+{
+    NetworkState state;
+    const Network* net = Client::network(netId);
+    if (net && !net->myNick().isEmpty()) {
+        state.isValid = true;
+        state.currentNick = net->myNick();
+        const Identity* myIdentity = Client::identity(net->identity());
+        if (myIdentity) {
+            state.identityNicks = myIdentity->nicks();
         }
-        _currentBatch = _processQueue.takeFirst();
     }
-    Message msg = _currentBatch.takeFirst();
-    process(msg);
+    return state;
 }
 
-void QtUiMessageProcessor::checkForHighlight(Message& msg)
+void QtUiMessageProcessor::checkForHighlight(Message& msg, NetworkStateCache& networkStates)
 {
     if (!((msg.type() & (Message::Plain | Message::Notice | Message::Action)) && !(msg.flags() & Message::Self)))
         return;
 
     // Cached per network
     const NetworkId& netId = msg.bufferInfo().networkId();
-    const Network* net = Client::network(netId);
+    auto stateIter = networkStates.constFind(netId);
+    if (stateIter == networkStates.constEnd())
+        stateIter = networkStates.insert(netId, networkState(netId));
+    const NetworkState& state = *stateIter;
 
-    if (net && !net->myNick().isEmpty()) {
-        // Get current nick
-        QString currentNick = net->myNick();
-        // Get identity nicks
-        QStringList identityNicks = {};
-        const Identity* myIdentity = Client::identity(net->identity());
-        if (myIdentity) {
-            identityNicks = myIdentity->nicks();
-        }
+    if (state.isValid) {
+        const QString& currentNick = state.currentNick;
+        const QStringList& identityNicks = state.identityNicks;
 
         // Get buffer name, message contents
         QString bufferName = msg.bufferInfo().bufferName();
-        QString msgContents = msg.contents();
+        // Strip once for all rules and the nick matcher
+        const QString msgContents = stripFormatCodes(msg.contents());
         bool matches = false;
 
         for (int i = 0; i < _highlightRuleList.count(); i++) {
@@ -149,7 +186,7 @@ void QtUiMessageProcessor::checkForHighlight(Message& msg)
             }
 
             // Check message according to specified rule, allowing empty rules to match
-            bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
+            bool contentsMatch = rule.contentsMatcher().match(msgContents, true);
 
             // Support for sender matching can be added here
 
@@ -168,7 +205,7 @@ void QtUiMessageProcessor::checkForHighlight(Message& msg)
         if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
             // Nickname matching allowed and current nickname is known
             // Run the nickname matcher on the unformatted string
-            if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
+            if (_nickMatcher.match(msgContents, netId, currentNick, identityNicks)) {
                 msg.setFlags(msg.flags() | Message::Highlight);
                 return;
             }
@@ -23,6 +23,8 @@
 
 #include <utility>
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QTimer>
 
 #include "abstractmessageprocessor.h"
@@ -61,7 +63,7 @@ public slots:
     void networkRemoved(NetworkId id) override;
 
 private slots:
-    void processNextMessage();
+    void processQueuedMessages();
     void nicksCaseSensitiveChanged(const QVariant& variant);
     void highlightListChanged(const QVariant& variant);
     void highlightNickChanged(const QVariant& variant);
@@ -199,7 +201,7 @@ private:
          *
          * @return Expression matcher to compare with message contents
          */
-        inline ExpressionMatch contentsMatcher() const
+        inline const ExpressionMatch& contentsMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -212,7 +214,7 @@ private:
          *
          * @return Expression matcher to compare with channel name
          */
-        inline ExpressionMatch chanNameMatcher() const
+        inline const ExpressionMatch& chanNameMatcher() const
         {
             if (_cacheInvalid) {
                 determineExpressions();
@@ -243,7 +245,34 @@ private:
 
     using LegacyHighlightRuleList = QList<LegacyHighlightRule>;
 
-    void checkForHighlight(Message& msg);
+    /**
+     * Per-network state needed for nickname highlights
+     */
+    struct NetworkState
+    {
+        bool isValid = false;            ///< False if the network is unknown or has no nick yet
+        QString currentNick = {};        ///< Current nick on the network
+        QStringList identityNicks = {};  ///< Nicks of the network's identity
+    };
+
+    using NetworkStateCache = QHash<NetworkId, NetworkState>;
+
+    /**
+     * Looks up the current highlight-relevant state of a network
+     *
+     * @param netId Network ID to look up
+     * @return Current state of the network
+     */
+    static NetworkState networkState(NetworkId netId);
+
+    /**
+     * Sets the Highlight flag on a message if it matches any highlight rule or nick
+     *
+     * @param msg            Message to check
+     * @param networkStates  Network states looked up so far; nicks can't change while processing
+     *                       a batch of messages, so this only needs to be filled once per batch
+     */
+    void checkForHighlight(Message& msg, NetworkStateCache& networkStates);
     void startProcessing();
 
     using HighlightNickType = NotificationSettings::HighlightNickType;
@@ -257,7 +286,10 @@ private:
 
     QList<QList<Message>> _processQueue;
     QList<Message> _currentBatch;
+    int _currentBatchPos{0};  ///< Index of the next message in _currentBatch to process
     QTimer _processTimer;
+    QElapsedTimer _runTimer;  ///< Started when messages are queued while idle
+    int _runCount{0};         ///< Messages queued since then
     bool _processing;
     Mode _processMode;
 };
@@ -94,7 +94,10 @@ void BufferViewFilter::configInitialized()
     if (!config())
         return;
 
-    connect(config(), &BufferViewConfig::configChanged, this, &QSortFilterProxyModel::invalidate);
+    connect(config(), &BufferViewConfig::bufferAdded, this, &BufferViewFilter::configMembershipChanged);
+    connect(config(), &BufferViewConfig::bufferRemoved, this, &BufferViewFilter::configMembershipChanged);
+    connect(config(), &BufferViewConfig::bufferPermanentlyRemoved, this, &BufferViewFilter::configMembershipChanged);
+    connect(config(), &BufferViewConfig::configChanged, this, &BufferViewFilter::configContentsChanged);
 
     disconnect(config(), &SyncableObject::initDone, this, &BufferViewFilter::configInitialized);
 
@@ -104,6 +107,25 @@ void BufferViewFilter::configInitialized()
     emit configChanged();
 }
 
+void BufferViewFilter::configMembershipChanged()
+{
+    // The config emits configChanged() right after this
+    _configMembershipChanged = true;
+}
+
+void BufferViewFilter::configContentsChanged()
+{
+    if (_configMembershipChanged && !_editMode) {
+        // Adding or removing a buffer doesn't change the relative order of the others, so there's no need to sort
+        // everything again; re-filtering inserts newly accepted rows at their sorted position
+        _configMembershipChanged = false;
+        invalidateFilter();
+        return;
+    }
+    _configMembershipChanged = false;
+    invalidate();
+}
+
 void BufferViewFilter::showServerQueriesChanged()
 {
     BufferSettings bufferSettings;
@@ -145,12 +167,12 @@ void BufferViewFilter::enableEditMode(bool enable)
         addBuffers(_toAdd.values());
         QSet<BufferId>::const_iterator iter;
         for (iter = _toTempRemove.constBegin(); iter != _toTempRemove.constEnd(); ++iter) {
-            if (config()->temporarilyRemovedBuffers().contains(*iter))
+            if (config()->isBufferTemporarilyRemoved(*iter))
                 continue;
             config()->requestRemoveBuffer(*iter);
         }
         for (iter = _toRemove.constBegin(); iter != _toRemove.constEnd(); ++iter) {
-            if (config()->removedBuffers().contains(*iter))
+            if (config()->isBufferRemoved(*iter))
                 continue;
             config()->requestRemoveBufferPermanently(*iter);
         }
@@ -212,7 +234,7 @@ bool BufferViewFilter::dropMimeData(const QMimeData* data, Qt::DropAction action
             if (row < rowCount(parent)) {
                 QModelIndex source_child = mapToSource(index(row, 0, parent));
                 BufferId beforeBufferId = sourceModel()->data(source_child, NetworkModel::BufferIdRole).value<BufferId>();
-                pos = config()->bufferList().indexOf(beforeBufferId);
+                pos = config()->bufferPosition(beforeBufferId);
                 if (_sortOrder == Qt::DescendingOrder)
                     pos++;
             }
@@ -223,8 +245,8 @@ bool BufferViewFilter::dropMimeData(const QMimeData* data, Qt::DropAction action
                     pos = 0;
             }
 
-            if (config()->bufferList().contains(bufferId) && !config()->sortAlphabetically()) {
-                if (config()->bufferList().indexOf(bufferId) < pos)
+            if (config()->containsBuffer(bufferId) && !config()->sortAlphabetically()) {
+                if (config()->bufferPosition(bufferId) < pos)
                     pos--;
                 auto* clientConf = qobject_cast<ClientBufferViewConfig*>(config());
                 if (!clientConf || !clientConf->isLocked())
@@ -249,16 +271,17 @@ void BufferViewFilter::sort(int column, Qt::SortOrder order)
 
 void BufferViewFilter::addBuffer(const BufferId& bufferId) const
 {
-    if (!config() || config()->bufferList().contains(bufferId))
+    if (!config() || config()->containsBuffer(bufferId))
         return;
 
-    int pos = config()->bufferList().count();
+    const QList<BufferId> bufferList = config()->bufferList();
+    int pos = bufferList.count();
     bool lt;
-    for (int i = 0; i < config()->bufferList().count(); i++) {
-        if (config() && config()->sortAlphabetically())
-            lt = bufferIdLessThan(bufferId, config()->bufferList()[i]);
+    for (int i = 0; i < bufferList.count(); i++) {
+        if (config()->sortAlphabetically())
+            lt = bufferIdLessThan(bufferId, bufferList[i]);
         else
-            lt = bufferId < config()->bufferList()[i];
+            lt = bufferId < bufferList[i];
 
         if (lt) {
             pos = i;
@@ -284,7 +307,7 @@ void BufferViewFilter::addBuffers(const QList<BufferId>& bufferIds) const
             if (config() && config()->sortAlphabetically())
                 lt = bufferIdLessThan(bufferId, bufferList[i]);
             else
-                lt = bufferId < config()->bufferList()[i];
+                lt = bufferId < bufferList[i];
 
             if (lt) {
                 pos = i;
@@ -307,12 +330,12 @@ bool BufferViewFilter::filterAcceptBuffer(const QModelIndex& source_bufferIndex)
 
     int activityLevel = sourceModel()->data(source_bufferIndex, NetworkModel::BufferActivityRole).toInt();
 
-    if (!config()->bufferList().contains(bufferId) && !_editMode) {
+    if (!config()->containsBuffer(bufferId) && !_editMode) {
         // add the buffer if...
-        if (config()->isInitialized() && !config()->removedBuffers().contains(bufferId)  // it hasn't been manually removed and either
+        if (config()->isInitialized() && !config()->isBufferRemoved(bufferId)  // it hasn't been manually removed and either
             && ((config()->addNewBuffersAutomatically()
-                 && !config()->temporarilyRemovedBuffers().contains(bufferId))  // is totally unknown to us (a new buffer)...
-                || (config()->temporarilyRemovedBuffers().contains(bufferId)
+                 && !config()->isBufferTemporarilyRemoved(bufferId))  // is totally unknown to us (a new buffer)...
+                || (config()->isBufferTemporarilyRemoved(bufferId)
                     && activityLevel > BufferInfo::OtherActivity))) {  // or was just temporarily hidden and has a new message waiting for us.
             addBuffer(bufferId);
         }
@@ -441,8 +464,8 @@ bool BufferViewFilter::bufferLessThan(const QModelIndex& source_left, const QMod
         // Otherwise, do the normal sorting (sorting happens within each priority bracket)
     }
     if (config()) {
-        int leftPos = config()->bufferList().indexOf(leftBufferId);
-        int rightPos = config()->bufferList().indexOf(rightBufferId);
+        int leftPos = config()->bufferPosition(leftBufferId);
+        int rightPos = config()->bufferPosition(rightBufferId);
         if (leftPos == -1 && rightPos == -1)
             return QSortFilterProxyModel::lessThan(source_left, source_right);
         if (leftPos == -1 || rightPos == -1)
@@ -497,10 +520,10 @@ QVariant BufferViewFilter::checkedState(const QModelIndex& index) const
     if (_toRemove.contains(bufferId))
         return Qt::Unchecked;
 
-    if (config()->bufferList().contains(bufferId))
+    if (config()->containsBuffer(bufferId))
         return Qt::Checked;
 
-    if (config()->temporarilyRemovedBuffers().contains(bufferId))
+    if (config()->isBufferTemporarilyRemoved(bufferId))
         return Qt::PartiallyChecked;
 
     return Qt::Unchecked;
@@ -84,6 +84,8 @@ signals:
 
 private slots:
     void configInitialized();
+    void configMembershipChanged();
+    void configContentsChanged();
     void enableEditMode(bool enable);
     void showServerQueriesChanged();
 
@@ -93,6 +95,7 @@ private:
 
     bool _showServerQueries;
     bool _editMode;
+    bool _configMembershipChanged{false};  ///< Buffers were only added to or removed from the config
     QAction _enableEditMode;
     QSet<BufferId> _toAdd;
     QSet<BufferId> _toTempRemove;
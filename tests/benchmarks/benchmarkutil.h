@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+/**
+ * Prints a benchmark result line, in the style of GTest's own output
+ *
+ * @param result Description of the result
+ */
+inline void reportBenchmark(const QString& result)
+{
+    std::cout << "[ BENCHMARK] " << qPrintable(result) << std::endl;
+}
+
+/**
+ * Calls the given function repeatedly and reports how long that took
+ *
+ * @param name        What is being measured
+ * @param iterations  Number of times to call func
+ * @param func        Function to measure
+ * @return Nanoseconds spent per iteration
+ */
+template<typename Func>
+qint64 measureBenchmark(const QString& name, qint64 iterations, Func&& func)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; ++i) {
+        func();
+    }
+    qint64 nsecs = timer.nsecsElapsed();
+
+    reportBenchmark(
+        QString("%1: %2 iterations in %3 ms (%4 ns each)").arg(name).arg(iterations).arg(nsecs / 1000000).arg(nsecs / iterations));
+    return nsecs / iterations;
+}
+
+/**
+ * Gets the resident memory of the current process
+ *
+ * @return Resident set size in bytes, or -1 if not supported on this platform
+ */
+inline qint64 residentMemory()
+{
+    QFile status{"/proc/self/status"};
+    if (!status.open(QIODevice::ReadOnly))
+        return -1;
+
+    for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+        if (line.startsWith("VmRSS:")) {
+            // Reported in kB
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+    }
+    return -1;
+}
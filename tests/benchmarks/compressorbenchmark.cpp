@@ -0,0 +1,236 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QDataStream>
+#include <QEventLoop>
+#include <QFile>
+#include <QHostAddress>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+#include "benchmarkutil.h"
+#include "compressor.h"
+#include "internalpeer.h"
+#include "ircchannel.h"
+#include "ircuser.h"
+#include "network.h"
+#include "protocols/datastream/datastreampeer.h"
+#include "signalproxy.h"
+
+namespace {
+
+// Serializes a message like DataStreamPeer does
+QByteArray serialize(const QVariantList& message)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_2);
+    stream << message;
+    return data;
+}
+
+QList<QByteArray> loadCapture(const QString& path)
+{
+    QList<QByteArray> messages;
+    QFile file{path};
+    if (!file.open(QIODevice::ReadOnly)) {
+        ADD_FAILURE() << "Could not open capture " << qPrintable(path);
+        return messages;
+    }
+
+    QByteArray data = file.readAll();
+    int pos = 0;
+    while (pos + 4 <= data.size()) {
+        auto size = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + pos));
+        pos += 4;
+        if (size > quint32(data.size() - pos)) {
+            ADD_FAILURE() << "Capture is truncated";
+            break;
+        }
+        messages << data.mid(pos, size);
+        pos += size;
+    }
+    return messages;
+}
+
+// Synthesizes the sync part of a session init for a network with a few big channels, followed by some chatter
+QList<QByteArray> synthesizeCapture()
+{
+    const int channelCount = 20;
+    const int usersPerChannel = 1000;
+    const int userCount = 5000;
+    const int syncCount = 20000;
+
+    SignalProxy proxy{SignalProxy::Server, nullptr};
+    Network network{NetworkId{1}};
+    network.setProxy(&proxy);
+
+    for (int c = 0; c < channelCount; ++c) {
+        IrcChannel* channel = network.newIrcChannel(QString("#channel%1").arg(c));
+        channel->setTopic(QString("Welcome to channel %1 | Be nice | https://example.org/channel%1").arg(c));
+        QList<IrcUser*> users;
+        QStringList modes;
+        for (int i = 0; i < usersPerChannel; ++i) {
+            int u = (c * 250 + i) % userCount;
+            IrcUser* user = network.newIrcUser(QString("user%1!~ident%1@host%1.example.org").arg(u));
+            user->setServer(QString("irc%1.example.org").arg(u % 10));
+            user->setRealName(QString("Real Name %1").arg(u));
+            users << user;
+            modes << (i % 50 == 0 ? "o" : i % 10 == 0 ? "v" : "");
+        }
+        channel->joinIrcUsers(users, modes);
+    }
+
+    QList<QByteArray> messages;
+
+    // The init data depends on the features of the peer it is meant for
+    InternalPeer peer;
+    proxy.setTargetPeer(&peer);
+    messages << serialize(QVariantList() << (qint16)DataStreamPeer::InitData << QByteArray("Network") << QByteArray("1")
+                                         << (QVariantList() << QByteArray("IrcUsersAndChannels") << network.initIrcUsersAndChannels()));
+    proxy.setTargetPeer(nullptr);
+
+    for (int i = 0; i < syncCount; ++i) {
+        QByteArray objectName = QString("1/user%1").arg(i * 7 % userCount).toUtf8();
+        QVariantList params;
+        switch (i % 4) {
+        case 0:
+            params << QByteArray("setAway") << true;
+            break;
+        case 1:
+            params << QByteArray("setAwayMessage") << QString("Gone since %1").arg(i);
+            break;
+        case 2:
+            params << QByteArray("partChannel") << QString("#channel%1").arg(i % channelCount);
+            break;
+        default:
+            params << QByteArray("setNick") << QString("nick%1").arg(i);
+        }
+        messages << serialize(QVariantList() << (qint16)DataStreamPeer::Sync << QByteArray("IrcUser") << objectName << params);
+    }
+
+    return messages;
+}
+
+/**
+ * Gets the messages to compress
+ *
+ * If QUASSEL_BENCHMARK_CAPTURE is set, it names a recorded capture: the uncompressed stream of a connection, where every
+ * message is prefixed with its size as a 32 bit big endian value, like RemotePeer writes them. Otherwise, a capture is
+ * synthesized from actual sync objects.
+ */
+QList<QByteArray> sessionCapture()
+{
+    static const QList<QByteArray> messages = [] {
+        QString path = QString::fromLocal8Bit(qgetenv("QUASSEL_BENCHMARK_CAPTURE"));
+        return path.isEmpty() ? synthesizeCapture() : loadCapture(path);
+    }();
+    return messages;
+}
+
+// Sends the capture through a pair of compressors over a loopback connection, and reports their statistics
+void benchmarkCompressor(const QString& name, Compressor::Algorithm algorithm, Compressor::CompressionLevel level)
+{
+    if (!Compressor::isSupported(algorithm)) {
+        reportBenchmark(QString("%1: not supported by this build").arg(name));
+        return;
+    }
+
+    const QList<QByteArray> messages = sessionCapture();
+    qint64 totalBytes = 0;
+    for (const QByteArray& message : messages)
+        totalBytes += 4 + message.size();
+
+    QTcpServer server;
+    ASSERT_TRUE(server.listen(QHostAddress::LocalHost));
+    QTcpSocket clientSocket;
+    clientSocket.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    ASSERT_TRUE(clientSocket.waitForConnected(5000));
+    ASSERT_TRUE(server.waitForNewConnection(5000));
+    QTcpSocket* serverSocket = server.nextPendingConnection();
+
+    Compressor sender{serverSocket, level, algorithm};
+    Compressor receiver{&clientSocket, level, algorithm};
+
+    QEventLoop loop;
+    qint64 receivedBytes = 0;
+    QObject::connect(&receiver, &Compressor::readyRead, &loop, [&] {
+        qint64 available = receiver.bytesAvailable();
+        receiver.consume(available);
+        receivedBytes += available;
+        if (receivedBytes >= totalBytes)
+            loop.quit();
+    });
+    QObject::connect(&sender, &Compressor::error, &loop, [&] {
+        ADD_FAILURE() << "Compression failed";
+        loop.quit();
+    });
+    QObject::connect(&receiver, &Compressor::error, &loop, [&] {
+        ADD_FAILURE() << "Decompression failed";
+        loop.quit();
+    });
+
+    // Send just like RemotePeer::writeMessage() does
+    QTimer::singleShot(0, &loop, [&] {
+        for (const QByteArray& message : messages) {
+            auto size = qToBigEndian<quint32>(message.size());
+            sender.write(reinterpret_cast<const char*>(&size), 4, Compressor::NoFlush);
+            sender.write(message.constData(), message.size());
+        }
+    });
+    QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    EXPECT_EQ(totalBytes, receivedBytes);
+
+    const Compressor::Statistics& sent = sender.statistics();
+    const Compressor::Statistics& received = receiver.statistics();
+    reportBenchmark(QString("%1: %2 messages, %3 KiB compressed to %4 KiB (%5%), compression %6 ms, decompression %7 ms")
+                        .arg(name)
+                        .arg(messages.size())
+                        .arg(sent.rawBytesOut / 1024)
+                        .arg(sent.compressedBytesOut / 1024)
+                        .arg(sent.rawBytesOut ? 100.0 * sent.compressedBytesOut / sent.rawBytesOut : 0, 0, 'f', 1)
+                        .arg(sent.compressionTimeNsec / 1000000)
+                        .arg(received.decompressionTimeNsec / 1000000));
+}
+
+}  // namespace
+
+TEST(CompressorBenchmark, deflate)
+{
+    // The level a core negotiates for deflate
+    benchmarkCompressor("Deflate", Compressor::Deflate, Compressor::BestCompression);
+}
+
+TEST(CompressorBenchmark, zstd)
+{
+    benchmarkCompressor("Zstd", Compressor::Zstd, Compressor::DefaultCompression);
+}
+
+TEST(CompressorBenchmark, lz4)
+{
+    benchmarkCompressor("LZ4", Compressor::Lz4, Compressor::DefaultCompression);
+}
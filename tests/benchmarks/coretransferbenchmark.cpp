@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "benchmarkutil.h"
+#include "coretransfer.h"
+#include "internalpeer.h"
+#include "protocol.h"
+#include "signalproxy.h"
+
+namespace {
+
+const qint64 fileSize = 256 * 1024 * 1024;
+const qint64 sendBlockSize = 64 * 1024;
+
+// Stands in for a connected client, counting the data relayed to it
+class CountingPeer : public InternalPeer
+{
+    Q_OBJECT
+
+public:
+    using InternalPeer::dispatch;
+    void dispatch(const Protocol::SyncMessage& msg) override
+    {
+        if (msg.slotName == "dataReceived")
+            relayedBytes += msg.params.last().toByteArray().size();
+    }
+
+    qint64 relayedBytes{0};
+};
+
+// Plays the DCC sender: sends fileSize bytes as fast as the receiver takes them, ignores the acks, then closes
+class DccSender : public QObject
+{
+    Q_OBJECT
+
+public:
+    DccSender()
+        : _block(sendBlockSize, 'x')
+    {
+        _server.listen(QHostAddress::LocalHost);
+        connect(&_server, &QTcpServer::newConnection, this, &DccSender::onNewConnection);
+    }
+
+    quint16 port() const { return _server.serverPort(); }
+
+private slots:
+    void onNewConnection()
+    {
+        _socket = _server.nextPendingConnection();
+        connect(_socket, &QIODevice::readyRead, _socket, [this] { _socket->readAll(); });
+        connect(_socket, &QIODevice::bytesWritten, this, &DccSender::sendMore);
+        sendMore();
+    }
+
+    void sendMore()
+    {
+        // Keep a few blocks in flight, like a send-ahead client would
+        while (_sent < fileSize && _socket->bytesToWrite() < 4 * sendBlockSize) {
+            _sent += _socket->write(_block.constData(), qMin(sendBlockSize, fileSize - _sent));
+        }
+        if (_sent == fileSize && !_closing) {
+            // Flushes the remaining data before closing
+            _closing = true;
+            _socket->disconnectFromHost();
+        }
+    }
+
+private:
+    QTcpServer _server;
+    QTcpSocket* _socket{nullptr};
+    QByteArray _block;
+    qint64 _sent{0};
+    bool _closing{false};
+};
+
+}  // namespace
+
+TEST(CoreTransferBenchmark, loopbackReceive)
+{
+    qRegisterMetaType<PeerPtr>("PeerPtr");
+
+    SignalProxy proxy{SignalProxy::Server, nullptr};
+    auto* peer = new CountingPeer;
+    ASSERT_TRUE(proxy.addPeer(peer));
+
+    DccSender sender;
+    CoreTransfer transfer{Transfer::Direction::Receive, "sender", "file.bin", QHostAddress::LocalHost, sender.port(), fileSize};
+    proxy.synchronize(&transfer);
+
+    QEventLoop loop;
+    QObject::connect(&transfer, &Transfer::statusChanged, &loop, [&](Transfer::Status status) {
+        if (status == Transfer::Status::Completed || status == Transfer::Status::Failed)
+            loop.quit();
+    });
+    QTimer::singleShot(60000, &loop, &QEventLoop::quit);
+
+    measureBenchmark(QString("Receive %1 MiB over loopback").arg(fileSize / (1024 * 1024)), 1, [&] {
+        transfer.requestAccepted(peer);
+        loop.exec();
+    });
+
+    EXPECT_EQ(Transfer::Status::Completed, transfer.status());
+    EXPECT_EQ(fileSize, peer->relayedBytes);
+}
+
+#include "coretransferbenchmark.moc"
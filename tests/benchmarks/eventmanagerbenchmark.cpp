@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QObject>
+
+#include "benchmarkutil.h"
+#include "event.h"
+#include "eventmanager.h"
+#include "ircevent.h"
+
+class BenchmarkEventManager : public EventManager
+{
+    Q_OBJECT
+
+protected:
+    Network* networkById(NetworkId) const override { return nullptr; }
+};
+
+class EventCounter : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void processIrcEventJoin(Event*) { ++count; }
+    void processIrcEvent001(Event*) { ++count; }
+    void processIrcEvent(Event*) { ++count; }
+
+public:
+    int count{0};
+};
+
+TEST(EventManagerBenchmark, dispatch)
+{
+    BenchmarkEventManager eventManager;
+    EventCounter first;
+    EventCounter second;
+    eventManager.registerObject(&first);
+    eventManager.registerObject(&second);
+
+    const int iterations = 100000;
+    measureBenchmark("Dispatch a named and a numeric event", iterations, [&] {
+        eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+        eventManager.postEvent(new IrcEventNumeric(1, nullptr, {}, "irc.example.org", "nick"));
+    });
+
+    EXPECT_EQ(2 * iterations, first.count);
+    EXPECT_EQ(2 * iterations, second.count);
+}
+
+#include "eventmanagerbenchmark.moc"
@@ -0,0 +1,100 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QHash>
+#include <QList>
+
+#include "benchmarkutil.h"
+#include "eventmanager.h"
+#include "ircdecoder.h"
+#include "irctag.h"
+#include "irctags.h"
+#include "util.h"
+
+namespace {
+
+QString decodeUtf8(const QByteArray& data)
+{
+    return QString::fromUtf8(data);
+}
+
+}  // namespace
+
+TEST(IrcDecoderBenchmark, parse)
+{
+    // Traffic as seen from a few differently behaving networks: tagged IRCv3 servers, plain RFC 1459 ones, numerics
+    const QList<QByteArray> capture{
+        "@time=2021-05-03T19:21:10.123Z;account=alice :alice!~alice@user/alice PRIVMSG #quassel :hello there",
+        "@time=2021-05-03T19:21:11.456Z :bob!~bob@203.0.113.7 JOIN #quassel * :Bob",
+        "@msgid=abc;time=2021-05-03T19:21:12.789Z :carol!carol@example.org NOTICE #quassel :Topic changed",
+        ":dave!dave@198.51.100.3 PART #quassel :Leaving",
+        ":irc.example.org 353 me = #quassel :@alice +bob carol dave",
+        ":irc.example.org 366 me #quassel :End of /NAMES list.",
+        ":eve!eve@eve.example.net QUIT :Ping timeout: 240 seconds",
+        "PING :irc.example.org",
+        ":frank!frank@frank.example.net MODE #quassel +o alice",
+        ":grace!grace@grace.example.net privmsg me :lower case command",
+    };
+
+    const int iterations = 20000;
+    int unknown = 0;
+    int timestamps = 0;
+    QHash<IrcTagKey, QString> tags;
+    QString prefix;
+    QString cmd;
+    QList<QByteArray> params;
+
+    measureBenchmark(QString("Parse %1 lines, resolve the command and server-time").arg(capture.size()), iterations, [&] {
+        for (const QByteArray& line : capture) {
+            tags.clear();
+            params.clear();
+            IrcDecoder::parseMessage(decodeUtf8, line, tags, prefix, cmd, params);
+            if (cmd.toUInt() == 0 && EventManager::ircEventTypeByCommand(cmd) == EventManager::Invalid)
+                ++unknown;
+            auto time = tags.constFind(IrcTags::SERVER_TIME);
+            if (time != tags.constEnd() && parseISODateTime(*time).isValid())
+                ++timestamps;
+        }
+    });
+
+    EXPECT_EQ(0, unknown);
+    EXPECT_EQ(3 * iterations, timestamps);
+}
+
+TEST(IrcDecoderBenchmark, tokenize)
+{
+    const QByteArray raw{"@time=2021-05-03T19:21:10.123Z;account=alice :alice!~alice@user/alice PRIVMSG #quassel :hello there"};
+    const int iterations = 200000;
+
+    IrcDecoder::Tokens tokens;
+    measureBenchmark("Tokenize a tagged line", iterations, [&] { IrcDecoder::tokenize(raw, tokens); });
+    EXPECT_EQ(2, tokens.parameters.size());
+
+    QHash<IrcTagKey, QString> tags;
+    QString prefix;
+    QString cmd;
+    QList<QByteArray> params;
+    measureBenchmark("Fully parse a tagged line", iterations, [&] {
+        IrcDecoder::parseMessage(decodeUtf8, raw, tags, prefix, cmd, params);
+    });
+    EXPECT_EQ(2, params.size());
+}
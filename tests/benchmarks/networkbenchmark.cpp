@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QStringList>
+
+#include "benchmarkutil.h"
+#include "ircchannel.h"
+#include "ircuser.h"
+#include "network.h"
+#include "signalproxy.h"
+
+TEST(NetworkBenchmark, bigChannels)
+{
+    // 20 channels of 10k users each, overlapping like channels on a big network do
+    const int channelCount = 20;
+    const int usersPerChannel = 10000;
+    const int userCount = 50000;
+
+    SignalProxy proxy{SignalProxy::Server, nullptr};
+    Network network{NetworkId{1}};
+    network.setProxy(&proxy);
+
+    qint64 memoryBefore = residentMemory();
+    measureBenchmark(QString("Join %1 channels of %2 users").arg(channelCount).arg(usersPerChannel), 1, [&] {
+        for (int c = 0; c < channelCount; ++c) {
+            IrcChannel* channel = network.newIrcChannel(QString("#channel%1").arg(c));
+            QList<IrcUser*> users;
+            QStringList modes;
+            for (int i = 0; i < usersPerChannel; ++i) {
+                int u = (c * 2500 + i) % userCount;
+                IrcUser* user = network.newIrcUser(QString("user%1!~ident%1@host%1.example.org").arg(u));
+                user->setServer(QString("irc%1.example.org").arg(u % 10));
+                users << user;
+                modes << (i % 50 == 0 ? "o" : i % 10 == 0 ? "v" : "");
+            }
+            channel->joinIrcUsers(users, modes);
+        }
+    });
+    qint64 memoryAfter = residentMemory();
+
+    EXPECT_EQ(quint32(userCount), network.ircUserCount());
+    EXPECT_EQ(quint32(channelCount), network.ircChannelCount());
+    if (memoryBefore >= 0 && memoryAfter >= 0) {
+        qint64 bytes = memoryAfter - memoryBefore;
+        reportBenchmark(QString("%1 users, %2 memberships: %3 MiB, %4 bytes per membership")
+                            .arg(userCount)
+                            .arg(channelCount * usersPerChannel)
+                            .arg(bytes / (1024 * 1024))
+                            .arg(bytes / (channelCount * usersPerChannel)));
+    }
+}
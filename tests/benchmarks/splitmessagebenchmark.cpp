@@ -0,0 +1,52 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include "benchmarkutil.h"
+#include "corenetwork.h"
+
+TEST(SplitMessageBenchmark, longMessage)
+{
+    const int maxLength = 400;
+
+    QString message;
+    while (message.size() < 16384) {
+        message += QString("The quick brown fox jumps over the lazy dog. ");
+        message += QString::fromUtf8("\xe6\x97\xa9\xe4\xb8\x8a\xe5\xa5\xbd\xef\xbc\x8c\xe4\xb8\x96\xe7\x95\x8c ");
+        message += QString::fromUtf8("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd\xf0\x9f\x8e\x89 ");
+    }
+
+    int encodes = 0;
+    QList<QList<QByteArray>> parts;
+    measureBenchmark(QString("Split %1 characters").arg(message.size()), 100, [&] {
+        encodes = 0;
+        parts = CoreNetwork::splitMessage(
+            message,
+            [&](QString& part) {
+                encodes++;
+                return QList<QByteArray>() << "#quassel" << part.toUtf8();
+            },
+            [&](const QList<QByteArray>& params) { return qMax(0, params.last().size() - maxLength); });
+    });
+
+    reportBenchmark(QString("%1 parts, %2 encodes").arg(parts.size()).arg(encodes));
+    EXPECT_GT(parts.size(), 1);
+}
@@ -0,0 +1,173 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+
+#include "benchmarkutil.h"
+#include "network.h"
+#include "quassel.h"
+#include "sqlitestorage.h"
+
+// Measures how backlog reads hold up while messages are being inserted concurrently, as happens when a client
+// fetches backlog from a busy core. The journal mode is taken from the command line, so run the benchmark both
+// without and with --sqlite-wal to compare the two.
+
+namespace {
+
+const int bufferCount = 50;
+const int prefillMessages = 200000;
+const int prefillBatchSize = 1000;
+// Roughly what a busy session stores per commit, see --storage-commit-interval
+const int insertBatchSize = 20;
+const int backlogReads = 500;
+const int backlogLimit = 500;
+
+// Keeps the database out of the configuration directory
+class BenchmarkStorage : public SqliteStorage
+{
+public:
+    explicit BenchmarkStorage(QString path)
+        : _path(std::move(path))
+    {}
+
+protected:
+    QString databaseName() override { return _path; }
+
+private:
+    QString _path;
+};
+
+MessageList createMessages(const std::vector<BufferInfo>& buffers, int count, int& serial)
+{
+    MessageList messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i, ++serial) {
+        messages << Message(QDateTime::currentDateTimeUtc(),
+                            buffers[serial % buffers.size()],
+                            Message::Plain,
+                            QString("Message %1, about as long as a typical line on a busy channel").arg(serial),
+                            QString("nick%1!user@host%1.example.org").arg(serial % 97),
+                            "",
+                            "Real Name",
+                            "",
+                            Message::None);
+    }
+    return messages;
+}
+
+/**
+ * Requests backlog for the buffers in turn, like a client does when switching between them
+ *
+ * @return Latency of each request in microseconds
+ */
+std::vector<qint64> readBacklog(SqliteStorage& storage, UserId user, const std::vector<BufferInfo>& buffers)
+{
+    std::vector<qint64> latencies;
+    latencies.reserve(backlogReads);
+    QElapsedTimer timer;
+    for (int i = 0; i < backlogReads; ++i) {
+        timer.start();
+        auto messages = storage.requestMsgs(user, buffers[i % buffers.size()].bufferId(), -1, -1, backlogLimit);
+        latencies.push_back(timer.nsecsElapsed() / 1000);
+        EXPECT_FALSE(messages.empty());
+    }
+    return latencies;
+}
+
+void reportLatencies(const QString& name, std::vector<qint64> latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    reportBenchmark(QString("%1: median %2 us, 99th percentile %3 us, max %4 us")
+                        .arg(name)
+                        .arg(latencies[latencies.size() / 2])
+                        .arg(latencies[latencies.size() * 99 / 100])
+                        .arg(latencies.back()));
+}
+
+}  // namespace
+
+TEST(SqliteStorageBenchmark, backlogReadsDuringInserts)
+{
+    Q_INIT_RESOURCE(sql);
+    Quassel quassel;
+    quassel.init(Quassel::RunMode::CoreOnly);
+    const QString mode = Quassel::isOptionSet("sqlite-wal") ? "WAL" : "rollback journal";
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    BenchmarkStorage storage{dir.filePath("quassel-storage.sqlite")};
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    ASSERT_TRUE(storage.setup({}, environment, false));
+    ASSERT_EQ(Storage::IsReady, storage.init({}, environment, false));
+
+    UserId user = storage.addUser("benchmark", "benchmark");
+    NetworkInfo networkInfo;
+    networkInfo.networkName = "Benchmark";
+    NetworkId networkId = storage.createNetwork(user, networkInfo);
+    std::vector<BufferInfo> buffers;
+    for (int i = 0; i < bufferCount; ++i) {
+        buffers.push_back(storage.bufferInfo(user, networkId, BufferInfo::ChannelBuffer, QString("#channel%1").arg(i)));
+        ASSERT_TRUE(buffers.back().isValid());
+    }
+
+    int serial = 0;
+    for (int i = 0; i < prefillMessages; i += prefillBatchSize) {
+        MessageList messages = createMessages(buffers, prefillBatchSize, serial);
+        ASSERT_TRUE(storage.logMessages(messages));
+    }
+
+    reportLatencies(QString("Backlog reads, %1, idle").arg(mode), readBacklog(storage, user, buffers));
+
+    // The writer runs on its own thread, and thus its own database connection, like a session does
+    std::atomic<bool> stop{false};
+    std::atomic<int> inserted{0};
+    std::thread writer([&] {
+        int writerSerial = serial;
+        while (!stop) {
+            MessageList messages = createMessages(buffers, insertBatchSize, writerSerial);
+            if (storage.logMessages(messages))
+                inserted += messages.count();
+        }
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<qint64> latencies = readBacklog(storage, user, buffers);
+    qint64 elapsed = timer.elapsed();
+    stop = true;
+    writer.join();
+
+    reportLatencies(QString("Backlog reads, %1, during inserts").arg(mode), latencies);
+    reportBenchmark(QString("Inserts, %1, during backlog reads: %2 messages in %3 ms (%4 per second)")
+                        .arg(mode)
+                        .arg(inserted.load())
+                        .arg(elapsed)
+                        .arg(elapsed > 0 ? inserted.load() * 1000 / elapsed : 0));
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+
+#include "testglobal.h"
+
+#include "bufferviewconfig.h"
+
+namespace {
+
+void expectPositionsMatchList(const BufferViewConfig& config)
+{
+    const QList<BufferId> buffers = config.bufferList();
+    for (int i = 0; i < buffers.count(); i++) {
+        EXPECT_EQ(i, config.bufferPosition(buffers[i]));
+        EXPECT_TRUE(config.containsBuffer(buffers[i]));
+    }
+}
+
+}  // namespace
+
+TEST(BufferViewConfigTest, positionsFollowListChanges)
+{
+    BufferViewConfig config{1};
+    config.setBufferList({BufferId{10}, BufferId{20}, BufferId{30}, BufferId{40}});
+    expectPositionsMatchList(config);
+    EXPECT_EQ(-1, config.bufferPosition(BufferId{50}));
+    EXPECT_FALSE(config.containsBuffer(BufferId{50}));
+
+    config.addBuffer(BufferId{50}, 1);
+    EXPECT_EQ(1, config.bufferPosition(BufferId{50}));
+    EXPECT_EQ(2, config.bufferPosition(BufferId{20}));
+    expectPositionsMatchList(config);
+
+    config.moveBuffer(BufferId{10}, 3);
+    EXPECT_EQ(3, config.bufferPosition(BufferId{10}));
+    EXPECT_EQ(0, config.bufferPosition(BufferId{50}));
+    expectPositionsMatchList(config);
+
+    config.moveBuffer(BufferId{40}, 0);
+    EXPECT_EQ(0, config.bufferPosition(BufferId{40}));
+    expectPositionsMatchList(config);
+}
+
+TEST(BufferViewConfigTest, removedBuffersLeaveList)
+{
+    BufferViewConfig config{1};
+    config.setBufferList({BufferId{10}, BufferId{20}, BufferId{30}});
+
+    config.removeBuffer(BufferId{10});
+    EXPECT_FALSE(config.containsBuffer(BufferId{10}));
+    EXPECT_TRUE(config.isBufferTemporarilyRemoved(BufferId{10}));
+    EXPECT_EQ(0, config.bufferPosition(BufferId{20}));
+    expectPositionsMatchList(config);
+
+    config.removeBufferPermanently(BufferId{30});
+    EXPECT_FALSE(config.containsBuffer(BufferId{30}));
+    EXPECT_TRUE(config.isBufferRemoved(BufferId{30}));
+    EXPECT_FALSE(config.isBufferTemporarilyRemoved(BufferId{30}));
+    expectPositionsMatchList(config);
+
+    config.addBuffer(BufferId{10}, 5);
+    EXPECT_EQ(1, config.bufferPosition(BufferId{10}));
+    EXPECT_FALSE(config.isBufferTemporarilyRemoved(BufferId{10}));
+    expectPositionsMatchList(config);
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QObject>
+#include <QStringList>
+
+#include "event.h"
+#include "eventmanager.h"
+#include "ircevent.h"
+
+class TestEventManager : public EventManager
+{
+    Q_OBJECT
+
+protected:
+    Network* networkById(NetworkId) const override { return nullptr; }
+};
+
+// Records the handlers called, in order
+class EventRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    EventRecorder(const QString& name, QStringList* calls)
+        : _name{name}
+        , _calls{calls}
+    {}
+
+    bool acceptJoin{true};
+
+public slots:
+    void processIrcEventJoin(Event*) { record("join"); }
+    void processIrcEventQuit(Event* event)
+    {
+        record("quit");
+        event->stop();
+    }
+    void processIrcEvent001(Event*) { record("001"); }
+    void processIrcEvent(Event*) { record("group"); }
+
+    bool filterIrcEventJoin(Event*) { return acceptJoin; }
+
+private:
+    void record(const QString& handler) { _calls->append(_name + ":" + handler); }
+
+private:
+    QString _name;
+    QStringList* _calls;
+};
+
+class EventManagerTest : public ::testing::Test
+{
+protected:
+    TestEventManager _eventManager;
+    QStringList _calls;
+    EventRecorder _first{"first", &_calls};
+    EventRecorder _second{"second", &_calls};
+};
+
+TEST_F(EventManagerTest, dispatchOrder)
+{
+    _eventManager.registerObject(&_first, EventManager::HighPriority);
+    _eventManager.registerObject(&_second, EventManager::NormalPriority);
+
+    _eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+    EXPECT_EQ(QStringList({"first:join", "second:join"}), _calls);
+
+    // Objects without a specific handler get the generic one for the event group
+    _calls.clear();
+    _eventManager.postEvent(new Event(EventManager::IrcEventPart));
+    EXPECT_EQ(QStringList({"first:group", "second:group"}), _calls);
+}
+
+TEST_F(EventManagerTest, numericEvents)
+{
+    _eventManager.registerObject(&_first);
+
+    // Numeric handlers come first, and objects having one don't get the generic handler called as well
+    _eventManager.postEvent(new IrcEventNumeric(1, nullptr, {}, "irc.example.org", "nick"));
+    EXPECT_EQ(QStringList({"first:001"}), _calls);
+
+    _calls.clear();
+    _eventManager.postEvent(new IrcEventNumeric(2, nullptr, {}, "irc.example.org", "nick"));
+    EXPECT_EQ(QStringList({"first:group"}), _calls);
+}
+
+TEST_F(EventManagerTest, filters)
+{
+    _eventManager.registerObject(&_first);
+    _eventManager.registerObject(&_second);
+
+    _first.acceptJoin = false;
+    _eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+    EXPECT_EQ(QStringList({"second:join"}), _calls);
+
+    _calls.clear();
+    _first.acceptJoin = true;
+    _eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+    EXPECT_EQ(QStringList({"first:join", "second:join"}), _calls);
+}
+
+TEST_F(EventManagerTest, stoppedEvents)
+{
+    _eventManager.registerObject(&_first);
+    _eventManager.registerObject(&_second);
+
+    _eventManager.postEvent(new Event(EventManager::IrcEventQuit));
+    EXPECT_EQ(QStringList({"first:quit"}), _calls);
+}
+
+TEST_F(EventManagerTest, registrationAfterDispatch)
+{
+    _eventManager.registerObject(&_first);
+    _eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+    EXPECT_EQ(QStringList({"first:join"}), _calls);
+
+    // Registering another object must not leave a stale dispatch table behind
+    _calls.clear();
+    _eventManager.registerObject(&_second);
+    _eventManager.postEvent(new Event(EventManager::IrcEventJoin));
+    EXPECT_EQ(QStringList({"first:join", "second:join"}), _calls);
+}
+
+TEST_F(EventManagerTest, ircEventTypeByCommand)
+{
+    EXPECT_EQ(EventManager::IrcEventPrivmsg, EventManager::ircEventTypeByCommand("PRIVMSG"));
+    EXPECT_EQ(EventManager::IrcEventPrivmsg, EventManager::ircEventTypeByCommand("privmsg"));
+    EXPECT_EQ(EventManager::IrcEventChghost, EventManager::ircEventTypeByCommand("ChgHost"));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("FOOBAR"));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand(""));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("NUMERICMASK"));
+
+    // Internal event types must not be reachable through commands sent by the server
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("RAWPRIVMSG"));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("rawnotice"));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("NUMERIC"));
+    EXPECT_EQ(EventManager::Invalid, EventManager::ircEventTypeByCommand("UNKNOWN"));
+}
+
+#include "eventmanagertest.moc"
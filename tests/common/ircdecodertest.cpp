@@ -301,3 +301,30 @@ TEST(IrcDecoderTest, tag_values)
                          "",
                          "COMMAND"));
 }
+
+TEST(IrcDecoderTest, tokenize)
+{
+    const QByteArray raw{"  @a=b;+c  :nick!user@host  PRIVMSG   #chan  :hello  world "};
+    IrcDecoder::Tokens tokens;
+    IrcDecoder::tokenize(raw, tokens);
+
+    EXPECT_EQ("a=b;+c", IrcDecoder::fragment(raw, tokens.tags));
+    EXPECT_EQ("nick!user@host", IrcDecoder::fragment(raw, tokens.prefix));
+    EXPECT_EQ("PRIVMSG", IrcDecoder::fragment(raw, tokens.command));
+    ASSERT_EQ(2, tokens.parameters.size());
+    EXPECT_EQ("#chan", IrcDecoder::fragment(raw, tokens.parameters[0]));
+    EXPECT_EQ("hello  world ", IrcDecoder::fragment(raw, tokens.parameters[1]));
+
+    QHash<IrcTagKey, QString> tags = IrcDecoder::decodeTags([](const QByteArray& data) { return QString::fromUtf8(data); }, raw, tokens.tags);
+    EXPECT_EQ(2, tags.size());
+    EXPECT_EQ("b", tags.value(IrcTagKey("", "a", false)));
+    EXPECT_TRUE(tags.contains(IrcTagKey("", "c", true)));
+
+    // Tokens are reset when reused
+    IrcDecoder::tokenize("PING", tokens);
+    EXPECT_TRUE(tokens.tags.isEmpty());
+    EXPECT_TRUE(tokens.prefix.isEmpty());
+    EXPECT_EQ(0, tokens.command.start);
+    EXPECT_EQ(4, tokens.command.length);
+    EXPECT_EQ(0, tokens.parameters.size());
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QThread>
+
+#include "metrics.h"
+
+namespace {
+
+class TestThread : public QThread
+{
+public:
+    explicit TestThread(std::function<void()> func)
+        : _func(std::move(func))
+    {}
+
+protected:
+    void run() override { _func(); }
+
+private:
+    std::function<void()> _func;
+};
+
+// Runs func on the given number of threads at once
+void runOnThreads(int count, const std::function<void()>& func)
+{
+    std::vector<std::unique_ptr<TestThread>> threads;
+    for (int i = 0; i < count; ++i) {
+        threads.emplace_back(new TestThread(func));
+        threads.back()->start();
+    }
+    for (auto&& thread : threads) {
+        thread->wait();
+    }
+}
+
+}  // namespace
+
+TEST(MetricsTest, counterSumsAllThreads)
+{
+    Metrics::Counter counter{"test_counter", "Test counter"};
+    EXPECT_EQ(0u, counter.value());
+
+    runOnThreads(8, [&counter] {
+        for (int j = 0; j < 1000; ++j) {
+            counter.add();
+        }
+        counter.add(5);
+    });
+
+    EXPECT_EQ(8u * 1005u, counter.value());
+}
+
+TEST(MetricsTest, histogramBuckets)
+{
+    Metrics::Histogram histogram{"test_histogram", "Test histogram"};
+    const auto& bounds = Metrics::Histogram::bucketBounds();
+
+    histogram.observe(0);
+    histogram.observe(bounds[0]);  // bounds are inclusive
+    histogram.observe(bounds[0] + 1);
+    histogram.observe(bounds[3]);
+    histogram.observe(bounds[Metrics::Histogram::bucketCount - 1] + 1);  // above all bounds
+
+    Metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(5u, snapshot.count);
+    EXPECT_EQ(0 + 2 * bounds[0] + 1 + bounds[3] + bounds[Metrics::Histogram::bucketCount - 1] + 1, snapshot.sumNsecs);
+
+    // Buckets are cumulative
+    EXPECT_EQ(2u, snapshot.buckets[0]);
+    EXPECT_EQ(3u, snapshot.buckets[1]);
+    EXPECT_EQ(3u, snapshot.buckets[2]);
+    EXPECT_EQ(4u, snapshot.buckets[3]);
+    EXPECT_EQ(4u, snapshot.buckets[Metrics::Histogram::bucketCount - 1]);
+}
+
+TEST(MetricsTest, histogramSumsAllThreads)
+{
+    Metrics::Histogram histogram{"test_histogram", "Test histogram"};
+
+    runOnThreads(8, [&histogram] {
+        for (int j = 0; j < 1000; ++j) {
+            histogram.observe(2000);
+        }
+    });
+
+    Metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(8000u, snapshot.count);
+    EXPECT_EQ(8000 * 2000, snapshot.sumNsecs);
+    EXPECT_EQ(0u, snapshot.buckets[0]);
+    EXPECT_EQ(8000u, snapshot.buckets[1]);
+}
+
+TEST(MetricsTest, registry)
+{
+    for (const Metrics::Histogram* histogram : Metrics::histograms()) {
+        EXPECT_TRUE(QByteArray(histogram->name()).startsWith("quassel_"));
+        EXPECT_TRUE(QByteArray(histogram->name()).endsWith("_seconds"));
+    }
+    EXPECT_EQ(&Metrics::ircLineParse(), Metrics::histograms().front());
+
+    const uint64_t before = Metrics::compressorRawBytes().value();
+    Metrics::compressorRawBytes().add(42);
+    EXPECT_EQ(before + 42, Metrics::compressorRawBytes().value());
+}
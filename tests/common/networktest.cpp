@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include <QString>
+
+#include "ircchannel.h"
+#include "ircuser.h"
+#include "network.h"
+
+TEST(NetworkTest, nickChangeReachesChannels)
+{
+    Network network{NetworkId{1}};
+    IrcChannel* channel = network.newIrcChannel("#quassel");
+    IrcUser* user = network.newIrcUser("alice!alice@example.org");
+    channel->joinIrcUsers({user}, {"o"});
+
+    IrcUser* renamedUser = nullptr;
+    QString newNick;
+    QObject::connect(channel, &IrcChannel::ircUserNickSet, [&](IrcUser* ircuser, QString nick) {
+        renamedUser = ircuser;
+        newNick = nick;
+    });
+
+    user->setNick("bob");
+    EXPECT_EQ(user, renamedUser);
+    EXPECT_EQ("bob", newNick);
+    EXPECT_EQ(user, network.ircUser("bob"));
+    EXPECT_EQ(nullptr, network.ircUser("alice"));
+    EXPECT_TRUE(channel->isKnownUser(user));
+    EXPECT_EQ("o", channel->userModes("bob"));
+}
+
+TEST(NetworkTest, ircUserStringsAreShared)
+{
+    Network network{NetworkId{1}};
+    IrcChannel* channel = network.newIrcChannel("#quassel");
+    IrcUser* alice = network.newIrcUser("alice!~ident@alice.example.org");
+    IrcUser* bob = network.newIrcUser("bob!~ident@bob.example.org");
+    channel->joinIrcUsers({alice, bob}, {"v", "v"});
+
+    // Build equal strings separately, so they only share data if interned
+    alice->setServer(QString("irc.") + "example.org");
+    bob->setServer(QString("irc.") + "example.org");
+
+    EXPECT_EQ(alice->server(), bob->server());
+    EXPECT_EQ(alice->server().constData(), bob->server().constData());
+    EXPECT_EQ(channel->userModes(alice).constData(), channel->userModes(bob).constData());
+
+    // Changing one user must not affect the other
+    channel->addUserMode(alice, "o");
+    EXPECT_EQ("ov", channel->userModes(alice));
+    EXPECT_EQ("v", channel->userModes(bob));
+    channel->removeUserMode(alice, "o");
+    EXPECT_EQ(channel->userModes(alice).constData(), channel->userModes(bob).constData());
+}
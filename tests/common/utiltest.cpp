@@ -38,3 +38,38 @@ TEST(UtilTest, formatDateTimeToOffsetISO)
     EXPECT_EQ(formatDateTimeToOffsetISO(dateTime.toOffsetFromUtc(7200)), QString("2006-01-02 16:04:05+02:00"));
     EXPECT_EQ(formatDateTimeToOffsetISO(dateTime.toTimeZone(QTimeZone{"UTC"})), QString("2006-01-02 14:04:05Z"));
 }
+
+TEST(UtilTest, parseISODateTime)
+{
+    const QDateTime expected{{2011, 10, 19}, {16, 40, 51, 620}, Qt::UTC};
+
+    EXPECT_EQ(parseISODateTime("2011-10-19T16:40:51.620Z"), expected);
+    EXPECT_EQ(parseISODateTime("2011-10-19T16:40:51.62Z"), expected);
+    EXPECT_EQ(parseISODateTime("2011-10-19T16:40:51.620999Z"), expected);
+    EXPECT_EQ(parseISODateTime("2011-10-19T18:40:51.620+02:00"), expected);
+    EXPECT_EQ(parseISODateTime("2011-10-19T11:40:51.620-0500"), expected);
+    EXPECT_EQ(parseISODateTime("2011-10-19T16:40:51Z"), expected.addMSecs(-620));
+    EXPECT_EQ(parseISODateTime("2011-10-19T16:40:51.620Z").timeSpec(), Qt::UTC);
+
+    EXPECT_FALSE(parseISODateTime("").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-10-19T16:40:51.620").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-10-19T16:40:51.Z").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-10-19T16:40:51.620Zjunk").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-13-19T16:40:51.620Z").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-10-19T25:40:51.620Z").isValid());
+    EXPECT_FALSE(parseISODateTime("2011-10-1916:40:51.620Z").isValid());
+}
+
+TEST(UtilTest, stripFormatCodes)
+{
+    EXPECT_EQ(stripFormatCodes("plain text"), QString("plain text"));
+    EXPECT_EQ(stripFormatCodes(""), QString(""));
+    EXPECT_EQ(stripFormatCodes("\x02" "bold\x02 \x1d" "italic\x0f"), QString("bold italic"));
+    EXPECT_EQ(stripFormatCodes("\x03" "4red\x03 \x03" "04,12both\x03" "none"), QString("red bothnone"));
+    EXPECT_EQ(stripFormatCodes("\x03" "123"), QString("3"));
+    EXPECT_EQ(stripFormatCodes("\x03" "4,x"), QString(",x"));
+    EXPECT_EQ(stripFormatCodes("\x03,5"), QString(",5"));
+    EXPECT_EQ(stripFormatCodes("\x04" "ff00AA,000000hex\x04" "12345"), QString("hex12345"));
+    EXPECT_EQ(stripFormatCodes("\x04" "ff00AA,00zz"), QString(",00zz"));
+    EXPECT_EQ(stripFormatCodes("\x11\x12\x16\x1e\x1f"), QString(""));
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include "bufferinfocache.h"
+
+namespace {
+
+const NetworkId networkId{1};
+
+/// Stands in for the storage backend, creating buffers with increasing ids on demand
+class FakeStorage
+{
+public:
+    BufferInfo bufferInfo(NetworkId netId, BufferInfo::Type type, const QString& bufferName, bool create)
+    {
+        lookups++;
+        auto it = buffers.constFind(bufferName.toLower());
+        if (it != buffers.constEnd())
+            return *it;
+        if (!create)
+            return {};
+        BufferInfo info{BufferId{nextId++}, netId, type, 0, bufferName};
+        buffers.insert(bufferName.toLower(), info);
+        return info;
+    }
+
+    void removeBuffer(BufferId bufferId)
+    {
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+            if (it->bufferId() == bufferId) {
+                buffers.erase(it);
+                return;
+            }
+        }
+    }
+
+    QHash<QString, BufferInfo> buffers;
+    int nextId{1};
+    int lookups{0};
+};
+
+BufferInfoCache makeCache(FakeStorage& storage)
+{
+    return BufferInfoCache{[&storage](NetworkId netId, BufferInfo::Type type, const QString& bufferName, bool create) {
+        return storage.bufferInfo(netId, type, bufferName, create);
+    }};
+}
+
+}  // namespace
+
+TEST(BufferInfoCacheTest, cachesLookups)
+{
+    FakeStorage storage;
+    BufferInfoCache cache = makeCache(storage);
+
+    BufferInfo info = cache.lookup(networkId, BufferInfo::ChannelBuffer, "#quassel");
+    ASSERT_TRUE(info.isValid());
+    EXPECT_EQ(info.bufferId(), cache.lookup(networkId, BufferInfo::ChannelBuffer, "#Quassel").bufferId());
+    EXPECT_EQ(QString{"#Quassel"}, cache.lookup(networkId, BufferInfo::ChannelBuffer, "#Quassel").bufferName());
+    EXPECT_EQ(1, storage.lookups);
+}
+
+TEST(BufferInfoCacheTest, doesNotCacheMissingBuffers)
+{
+    FakeStorage storage;
+    BufferInfoCache cache = makeCache(storage);
+
+    EXPECT_FALSE(cache.lookup(networkId, BufferInfo::QueryBuffer, "nick", false).isValid());
+    EXPECT_FALSE(cache.cached(networkId, "nick").isValid());
+    EXPECT_TRUE(cache.lookup(networkId, BufferInfo::QueryBuffer, "nick").isValid());
+    EXPECT_TRUE(cache.cached(networkId, "nick").isValid());
+}
+
+TEST(BufferInfoCacheTest, messageAfterRemovalRecreatesBuffer)
+{
+    FakeStorage storage;
+    BufferInfoCache cache = makeCache(storage);
+
+    BufferId removed = cache.lookup(networkId, BufferInfo::QueryBuffer, "nick").bufferId();
+
+    // The client asks for the buffer to be removed; the storage backend deletes it later on
+    cache.beginRemoval(removed);
+    EXPECT_FALSE(cache.cached(networkId, "nick").isValid());
+
+    // A message arriving before the deletion must not pin the dying buffer in the cache
+    EXPECT_EQ(removed, cache.lookup(networkId, BufferInfo::QueryBuffer, "nick").bufferId());
+    EXPECT_FALSE(cache.cached(networkId, "nick").isValid());
+
+    storage.removeBuffer(removed);
+    cache.endRemoval(removed);
+
+    // The next message recreates the buffer, which is cached again
+    BufferInfo recreated = cache.lookup(networkId, BufferInfo::QueryBuffer, "nick");
+    ASSERT_TRUE(recreated.isValid());
+    EXPECT_NE(removed, recreated.bufferId());
+    EXPECT_EQ(recreated.bufferId(), cache.cached(networkId, "nick").bufferId());
+}
+
+TEST(BufferInfoCacheTest, evictsRenamedBuffersAndNetworks)
+{
+    FakeStorage storage;
+    BufferInfoCache cache = makeCache(storage);
+
+    BufferId bufferId = cache.lookup(networkId, BufferInfo::QueryBuffer, "nick").bufferId();
+    cache.lookup(networkId, BufferInfo::ChannelBuffer, "#quassel");
+
+    cache.evict(bufferId);
+    EXPECT_FALSE(cache.cached(networkId, "nick").isValid());
+    EXPECT_TRUE(cache.cached(networkId, "#quassel").isValid());
+
+    cache.evictNetwork(networkId);
+    EXPECT_FALSE(cache.cached(networkId, "#quassel").isValid());
+}
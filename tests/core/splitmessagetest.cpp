@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2022 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "testglobal.h"
+
+#include "corenetwork.h"
+
+namespace {
+
+const int maxLength = 100;
+
+class Splitter
+{
+public:
+    QList<QList<QByteArray>> split(const QString& message)
+    {
+        return CoreNetwork::splitMessage(
+            message,
+            [this](QString& part) {
+                encodes++;
+                return QList<QByteArray>() << "#quassel" << part.toUtf8();
+            },
+            [](const QList<QByteArray>& params) { return qMax(0, params.last().size() - maxLength); });
+    }
+
+    int encodes{0};
+};
+
+void checkParts(const QString& message, const QList<QList<QByteArray>>& parts)
+{
+    QString joined;
+    for (const QList<QByteArray>& part : parts) {
+        ASSERT_EQ(2, part.size());
+        EXPECT_LE(part.last().size(), maxLength);
+        joined += QString::fromUtf8(part.last());
+    }
+    // Nothing may be lost or mangled, e.g. by splitting surrogate pairs
+    EXPECT_EQ(message, joined);
+}
+
+}  // namespace
+
+TEST(SplitMessageTest, shortMessage)
+{
+    Splitter splitter;
+    auto parts = splitter.split("Hello world");
+    ASSERT_EQ(1, parts.size());
+    EXPECT_EQ("Hello world", parts.first().last());
+    EXPECT_EQ(1, splitter.encodes);
+
+    parts = splitter.split("");
+    ASSERT_EQ(1, parts.size());
+    EXPECT_TRUE(parts.first().last().isEmpty());
+}
+
+TEST(SplitMessageTest, wordBoundaries)
+{
+    QString message;
+    while (message.size() < 1000)
+        message += QString("word%1 ").arg(message.size());
+
+    Splitter splitter;
+    auto parts = splitter.split(message);
+    checkParts(message, parts);
+    ASSERT_GT(parts.size(), 1);
+    for (int i = 0; i < parts.size() - 1; ++i) {
+        // Parts end between words, and are not split much earlier than needed
+        QByteArray text = parts[i].last();
+        EXPECT_FALSE(text.at(text.size() - 1) != ' ' && parts[i + 1].last().at(0) != ' ') << text.constData();
+        EXPECT_GT(text.size(), maxLength - 16);
+    }
+}
+
+TEST(SplitMessageTest, graphemeBoundaries)
+{
+    // A single long "word" has to be split along graphemes
+    QString ascii(500, 'x');
+    Splitter splitter;
+    auto parts = splitter.split(ascii);
+    checkParts(ascii, parts);
+    EXPECT_EQ(5, parts.size());
+
+    QString cjk;
+    for (int i = 0; i < 200; ++i)
+        cjk += QChar(0x4e2d + i % 16);
+    checkParts(cjk, splitter.split(cjk));
+
+    QString emoji;
+    for (int i = 0; i < 100; ++i)
+        emoji += QString::fromUtf8("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd");  // thumbs up with skin tone modifier
+    checkParts(emoji, splitter.split(emoji));
+}
+
+TEST(SplitMessageTest, encodeCount)
+{
+    QString message;
+    while (message.size() < 4096) {
+        message += QString("The quick brown fox jumps over the lazy dog. ");
+        message += QString::fromUtf8("\xe6\x97\xa9\xe4\xb8\x8a\xe5\xa5\xbd\xef\xbc\x8c\xe4\xb8\x96\xe7\x95\x8c ");
+        message += QString::fromUtf8("\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd\xf0\x9f\x8e\x89 ");
+    }
+
+    Splitter splitter;
+    auto parts = splitter.split(message);
+    checkParts(message, parts);
+
+    // Split points are binary searched, so besides encoding the remaining message, each part takes at most
+    // floor(log2(n)) + 1 encodes for word and for grapheme boundaries each. A part can't have more than maxLength
+    // boundaries of either kind.
+    int probes = 1;
+    while ((1 << probes) <= maxLength)
+        ++probes;
+    EXPECT_LE(splitter.encodes, parts.size() * (1 + 2 * probes));
+}